@@ -0,0 +1,282 @@
+/*
+ * benchmark/AggregateBenchmark.cc
+ *
+ * Copyright (C) 2020 Linas Vepstas <linasvepstas@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <random>
+#include <string>
+
+#include <opencog/atoms/atom_types/atom_types.h>
+#include <opencog/atoms/value/FloatValue.h>
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/guile/SchemeEval.h>
+#include <opencog/util/Logger.h>
+
+#include <opencog/generate/Aggregate.h>
+#include <opencog/generate/BasicParameters.h>
+#include <opencog/generate/CompactLexis.h>
+#include <opencog/generate/Dictionary.h>
+#include <opencog/generate/RandomCallback.h>
+#include <opencog/generate/SimpleCallback.h>
+
+using namespace opencog;
+
+/// Aggregation benchmarks. Each of the bundled dictionaries is run
+/// with both the `SimpleCallback` and the `RandomCallback`, with a
+/// fixed seed, and the results are printed as JSON, one line per run,
+/// so that the output of two releases can be compared by a script.
+/// `make benchmark` runs it; or, by hand,
+///
+///    aggregate-benchmark [-s seed] [-n max-steps] [-r repeats]
+///                        [-l lexis-size]
+///
+/// The default is a seed of 42, and 2000 steps; the simple callback
+/// on the SEIR lexis is by far the slowest of the runs. Repeats are
+/// run with the next seeds. The time to load a large, made-up lexis
+/// into a dictionary is measured as well, and the time to map it back
+/// in, once compiled to a file; by default, it has 100000 sections.
+/// The peak RSS is that of the whole process, so far; it only grows,
+/// and so it is meaningful only for the largest of the runs, or when
+/// the runs are done one at a time.
+
+struct Case
+{
+	const char* name;
+	const char* file;
+	const char* root;
+
+	/// Directional connectors (+ and -) or undirected ones (*).
+	bool directional;
+
+	/// The weight key of the lexis; the dictionaries that have none
+	/// get a uniform weight, under the key "weights".
+	const char* weights;
+};
+
+static const Case cases[] =
+{
+	{"tree", "tests/generate/dict-tree.scm", "LEFT-WALL", true, nullptr},
+	{"loop", "tests/generate/dict-loop.scm", "LEFT-WALL", true, nullptr},
+	{"biloop", "tests/generate/dict-biloop.scm", "LEFT-WALL", true, nullptr},
+	{"quad", "tests/generate/dict-quad.scm", "LEFT-WALL", true, nullptr},
+	{"biquad", "tests/generate/dict-biquad.scm", "LEFT-WALL", true, nullptr},
+	{"triquad", "tests/generate/dict-triquad.scm", "LEFT-WALL", true, nullptr},
+	{"mixed", "tests/generate/dict-mixed.scm", "LEFT-WALL", true, nullptr},
+	{"basic-network", "tests/generate/basic-network.scm", "peep 3",
+		false, "weights"},
+	{"seir", "benchmark/seir-lexis.scm", "person-2-3",
+		false, "node likelihood"},
+};
+
+struct Options
+{
+	unsigned long seed = 42;
+	size_t max_steps = 2000;
+	size_t repeats = 1;
+	size_t lexis_size = 100000;
+};
+
+/// Peak resident set size of the process, in kilobytes.
+static long peak_rss(void)
+{
+	struct rusage ru;
+	getrusage(RUSAGE_SELF, &ru);
+	return ru.ru_maxrss;
+}
+
+/// Load the case into a fresh atomspace, and build its dictionary.
+static Dictionary load(AtomSpace* as, const Case& cs, Handle& weights)
+{
+	SchemeEval eval(as);
+	eval.eval("(add-to-load-path \"" PROJECT_SOURCE_DIR "\")");
+	eval.eval(std::string("(load-from-path \"") + cs.file + "\")");
+
+	Dictionary dict(as);
+	if (cs.directional)
+	{
+		Handle plus = as->add_node(CONNECTOR_DIR_NODE, "+");
+		Handle minus = as->add_node(CONNECTOR_DIR_NODE, "-");
+		dict.add_pole_pair(plus, minus);
+		dict.add_pole_pair(minus, plus);
+	}
+	else
+	{
+		Handle any = as->add_node(CONNECTOR_DIR_NODE, "*");
+		dict.add_pole_pair(any, any);
+	}
+
+	HandleSet lex;
+	as->get_handles_by_type(lex, SECTION);
+	dict.add_to_lexis(lex);
+
+	weights = as->add_node(PREDICATE_NODE, cs.weights ? cs.weights : "weights");
+	if (nullptr == cs.weights)
+		for (const Handle& sect : lex)
+			sect->setValue(weights, createFloatValue(1.0));
+
+	return dict;
+}
+
+static void run(const Case& cs, const char* cbname, size_t rep,
+                const Options& opts)
+{
+	AtomSpacePtr asp = createAtomSpace();
+	AtomSpace* as = asp.get();
+	Handle weights;
+	Dictionary dict(load(as, cs, weights));
+	Handle root = as->add_node(CONCEPT_NODE, cs.root);
+
+	BasicParameters basic;
+	SimpleCallback scb(as, dict);
+	RandomCallback rcb(as, dict, basic);
+	rcb.set_weight_key(weights);
+
+	GenerateCallback* cb = &scb;
+	if ('r' == cbname[0])
+	{
+		cb = &rcb;
+
+		// As in the SEIR demo: always try to close connectors, and
+		// allow large networks.
+		if (0 == std::string("seir").compare(cs.name))
+		{
+			basic.close_fraction = 1.0;
+			rcb.max_depth = 100;
+			rcb.max_network_size = 2000;
+			rcb.max_solutions = 1;
+		}
+	}
+	cb->max_steps = opts.max_steps;
+	cb->random_seed = opts.seed + rep;
+
+	Aggregate ag(as);
+	ag.aggregate({root}, *cb);
+	Handle result = cb->get_solutions();
+
+	const AggregateStats& st = ag.stats();
+	size_t steps = cb->num_steps();
+	size_t nsolns = result->get_arity();
+	double secs = st.elapsed;
+	double per = (0.0 < secs) ? 1.0 / secs : 0.0;
+
+	printf("{\"dict\": \"%s\", \"callback\": \"%s\", \"seed\": %lu, "
+		"\"max_steps\": %lu, \"steps\": %lu, \"solutions\": %lu, "
+		"\"secs\": %g, \"steps_per_sec\": %g, \"solutions_per_sec\": %g, "
+		"\"first_solution_secs\": %g, \"odometers\": %lu, "
+		"\"scratch_atoms\": %lu, \"peak_rss_kb\": %ld}\n",
+		cs.name, cbname, cb->random_seed, opts.max_steps, steps, nsolns,
+		secs, steps * per, nsolns * per, st.first_solution,
+		st.odo_pushes, st.scratch_atoms, peak_rss());
+	fflush(stdout);
+}
+
+/// Load a made-up lexis of `opts.lexis_size` sections, each with a
+/// point of its own, and one to four connectors, out of a thousand
+/// link types, into a dictionary.
+static void load_lexis(const Options& opts)
+{
+	AtomSpacePtr asp = createAtomSpace();
+	AtomSpace* as = asp.get();
+	Handle poles[2] = {
+		as->add_node(CONNECTOR_DIR_NODE, "+"),
+		as->add_node(CONNECTOR_DIR_NODE, "-")};
+
+	std::mt19937 rng(opts.seed);
+	HandleSeq lex;
+	lex.reserve(opts.lexis_size);
+	for (size_t i = 0; i < opts.lexis_size; i++)
+	{
+		HandleSeq cons;
+		size_t arity = 1 + rng() % 4;
+		for (size_t j = 0; j < arity; j++)
+		{
+			Handle linkty = as->add_node(CONCEPT_NODE,
+				"L" + std::to_string(rng() % 1000));
+			cons.push_back(as->add_link(CONNECTOR, linkty, poles[rng() % 2]));
+		}
+		Handle point = as->add_node(CONCEPT_NODE, "w" + std::to_string(i));
+		lex.push_back(as->add_link(SECTION, point,
+			as->add_link(CONNECTOR_SEQ, std::move(cons))));
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	Dictionary dict(as);
+	dict.add_pole_pair(poles[0], poles[1]);
+	dict.add_pole_pair(poles[1], poles[0]);
+	dict.add_to_lexis(lex);
+	std::chrono::duration<double> secs =
+		std::chrono::steady_clock::now() - start;
+
+	// The same, compiled to a file, and mapped back in.
+	std::string path = "/tmp/aggregate-benchmark-" +
+		std::to_string(getpid()) + ".lexis";
+	CompactLexis(dict).save(path);
+	start = std::chrono::steady_clock::now();
+	CompactLexis mapped(as, path);
+	std::chrono::duration<double> map_secs =
+		std::chrono::steady_clock::now() - start;
+	unlink(path.c_str());
+
+	printf("{\"dict\": \"synthetic\", \"sections\": %lu, "
+		"\"load_secs\": %g, \"sections_per_sec\": %g, "
+		"\"map_secs\": %g, \"peak_rss_kb\": %ld}\n",
+		dict.lexis().size(), secs.count(),
+		(0.0 < secs.count()) ? lex.size() / secs.count() : 0.0,
+		map_secs.count(), peak_rss());
+	fflush(stdout);
+}
+
+int main(int argc, char* argv[])
+{
+	Options opts;
+	int c;
+	while (-1 != (c = getopt(argc, argv, "s:n:r:l:")))
+	{
+		switch (c)
+		{
+			case 's': opts.seed = strtoul(optarg, nullptr, 10); break;
+			case 'n': opts.max_steps = strtoul(optarg, nullptr, 10); break;
+			case 'r': opts.repeats = strtoul(optarg, nullptr, 10); break;
+			case 'l': opts.lexis_size = strtoul(optarg, nullptr, 10); break;
+			default:
+				fprintf(stderr, "Usage: %s [-s seed] [-n max-steps] "
+					"[-r repeats] [-l lexis-size]\n", argv[0]);
+				return 1;
+		}
+	}
+
+	logger().set_level(Logger::WARN);
+	logger().set_print_to_stdout_flag(false);
+
+	for (const Case& cs : cases)
+		for (const char* cbname : {"simple", "random"})
+			for (size_t rep = 0; rep < opts.repeats; rep++)
+				run(cs, cbname, rep, opts);
+
+	if (0 < opts.lexis_size) load_lexis(opts);
+
+	return 0;
+}
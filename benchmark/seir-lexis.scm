@@ -0,0 +1,37 @@
+;
+; seir-lexis.scm
+;
+; The person-type lexis from the SEIR demo (see `demo/seir.scm`), less
+; the simulation. Each person-type is a point with some number of
+; "friend" and some number of "stranger" connectors, all of them
+; undirected; people with many relationships are made unlikely.
+;
+(use-modules (srfi srfi-1))
+(use-modules (opencog) (opencog exec))
+
+(define node-weight (Predicate "node likelihood"))
+(define prototypes (Concept "Prototype Individual Anchor Point"))
+
+(define (make-person-type Nfriends Nstrangers)
+	(define label (format #f "person-~D-~D" Nfriends Nstrangers))
+	(Section
+		(Concept label)
+		(ConnectorSeq
+			(make-list Nfriends
+				(Connector (Concept "friend") (ConnectorDir "*")))
+			(make-list Nstrangers
+				(Connector (Concept "stranger") (ConnectorDir "*"))))))
+
+; 1 to 6 friends, 3 to 10 strangers, as in the demo.
+(for-each (lambda (num-friends)
+	(for-each (lambda (num-strangers)
+			(define person-type (make-person-type num-friends num-strangers))
+			(define weight (/ 1.0
+				(* (+ num-friends num-strangers) num-friends num-strangers)))
+			(cog-set-value! person-type node-weight (FloatValue weight))
+			(Member person-type prototypes))
+		(iota 8 3)))
+	(iota 6 1))
+
+; The root used by the demo.
+(define seed (gar (make-person-type 2 3)))
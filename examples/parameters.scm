@@ -32,6 +32,13 @@
 ; this will be grammar dependent.)
 (define max-steps (Predicate "*-max-steps-*"))
 
+; The maximum wall-clock time to spend searching, in seconds. When the
+; time runs out, the search stops, and the networks found so far are
+; returned. Unlike max-steps, this does not depend on the speed of the
+; machine. Floating point; defaults to 0 (no limit). A running search
+; can also be stopped from another thread with `cog-aggregate-cancel`.
+(define max-time (Predicate "*-max-time-*"))
+
 ; Maximum depth of exploration. Starting from the nucleation points,
 ; sections are chained on, forming a branching tree of chains. (They
 ; may also interlink, thus forming a network rathr than a linear
@@ -43,6 +50,101 @@
 ; this number of points in them will not be explored.
 (define max-network-size (Predicate "*-max-network-size-*"))
 
+; Number of threads to use. For the random network generator, each
+; thread independently generates random networks. For the simple
+; (exhaustive) generator, the search is split up among the threads,
+; and the same set of networks is found as with a single thread. The
+; max-steps and max-solutions limits above are shared by all of the
+; threads. Integer, defaults to 1.
+(define num-threads (Predicate "*-num-threads-*"))
+
+; Use the compact engine. If non-zero, networks are assembled out of
+; integer IDs, instead of atoms; atoms are created only for the
+; finished networks. This is much faster, but runs on one thread
+; only; num-threads is ignored. Defaults to 0.
+(define compact-engine (Predicate "*-compact-engine-*"))
+
+; A compiled lexis, for the compact engine. The value is a node; its
+; name is the name of a file. If the file exists, and was compiled
+; from the same poles and lexis, the lexis in it is mapped into memory,
+; and used instead of the one in the AtomSpace; else it is written, for
+; the next time. See `cog-compile-lexis`. Not set by default.
+(define lexis-file (Predicate "*-lexis-file-*"))
+
+; Report each shape of network only once. Two networks have the same
+; shape if they are the same graph, with the same point types and link
+; types, differing only in the naming of the individual points. If
+; non-zero, only the first network of each shape is kept; the
+; max-solutions limit then counts distinct shapes. Defaults to 0.
+(define dedup-isomorphic (Predicate "*-dedup-isomorphic-*"))
+
+; Skip search states that are mirror images of one another. If two
+; open connectors are interchangeable (the same connector, on the same
+; section, or on two sections that are twins), then only one of the
+; ways of attaching new sections to them is explored. The order of the
+; connectors in a section is ignored. Meant for the simple (exhaustive)
+; aggregation. Defaults to 0.
+(define break-symmetry (Predicate "*-break-symmetry-*"))
+
+; Remember dead ends. A dead end is a set of open sections from which
+; no network could be completed. The same set is often reached again,
+; by attaching the same pieces in a different order; it is then
+; skipped. This is the number of dead ends to remember; when there
+; are more, the least recently used ones are forgotten. Meant for the
+; simple (exhaustive) aggregation; the compact engine ignores it.
+; Integer, defaults to 0 (don't remember any).
+(define memo-size (Predicate "*-memo-size-*"))
+
+; Prune the lexis before starting. Sections having a connector that
+; cannot be attached to any other section are removed; this is
+; repeated until nothing more can be removed. Then sections that
+; cannot be reached from the root are removed. A summary of what was
+; removed is logged at the INFO level. Defaults to 0 (don't prune).
+(define prune-lexis (Predicate "*-prune-lexis-*"))
+
+; Skip partial networks that cannot be finished within the max-network-size
+; and max-depth limits. Normally, only the finished points count towards
+; the network size; with this set, the unfinished points count too, as do
+; the fewest points that would have to be added to finish them. This
+; is a lower bound, so no network within the limits is lost; but networks
+; larger than max-network-size, that would otherwise slip through, are
+; no longer found. The compact engine ignores this. Defaults to 0.
+(define admissible-bounds (Predicate "*-admissible-bounds-*"))
+
+; Lower max-depth and max-network-size to the bounds suggested by an
+; analysis of the lexis weights, before starting. The lexis is treated
+; as a branching process: if, on average, each open connector leads to
+; more than one new open connector, most networks never stop growing,
+; and a warning is logged. The results of the analysis are left on the
+; parameters; see cog-growth-analysis. The bounds are only ever lowered.
+; Only for cog-random-aggregate. Defaults to 0.
+(define auto-bounds (Predicate "*-auto-bounds-*"))
+
+; Try the most constrained connectors first. The connectors that can
+; be closed in the fewest ways are decided first, so that dead ends
+; are found early, instead of after trying every combination of the
+; other connectors. The same networks are found, but in a different
+; order. The compact engine ignores this. Defaults to 0.
+(define most-constrained-first (Predicate "*-most-constrained-first-*"))
+
+; Grow a population of partial networks, instead of one network at a
+; time. This many partial networks are kept; each round, they are drawn
+; by weight (favoring those with the fewest unconnected connectors) and
+; grown by one layer. Finished networks are reported, and those that
+; cannot be grown any further are dropped; there is no backtracking.
+; Only for cog-random-aggregate; num-threads is ignored. Integer, zero
+; or more; defaults to 0 (grow one network at a time, backtracking as
+; needed).
+(define population-size (Predicate "*-population-size-*"))
+
+; Seed for the random number generators. With a non-zero seed, the
+; same cog-random-aggregate, with the same dictionary and parameters,
+; generates the same networks every time; this is handy for debugging,
+; and for benchmarks. Not repeatable with num-threads greater than one,
+; as the threads race one another. Defaults to 0 (a fresh seed each
+; time).
+(define random-seed (Predicate "*-random-seed-*"))
+
 ; When the network is generated, many individual instances of the
 ; network points will be generated. To get easy access to these, they
 ; can be tied at a well-known location -- specifically, they will
@@ -18,6 +18,9 @@
  */
 
 #include <stdio.h>
+#include <algorithm>
+#include <cstdint>
+#include <tuple>
 
 #include <opencog/util/Logger.h>
 
@@ -26,7 +29,10 @@
 #include <opencog/atomspace/AtomSpace.h>
 
 #include "Aggregate.h"
+#include "Canonical.h"
 #include "GenerateCallback.h"
+#include "ParallelAggregate.h"
+#include "Trace.h"
 
 using namespace opencog;
 
@@ -39,6 +45,17 @@ Aggregate::Aggregate(AtomSpace* as)
 {
 	_cb = nullptr;
 	_scratch = nullptr;
+	_odo_base = 0;
+	_pool = nullptr;
+	_pool_id = 0;
+	_top = 0;
+	_next = ENTER;
+	_found = false;
+	_in_root = false;
+	_redundant = false;
+	_reclaim = true;
+	_num_solved = 0;
+	_num_spawned = 0;
 }
 
 Aggregate::~Aggregate()
@@ -49,11 +66,21 @@ Aggregate::~Aggregate()
 void Aggregate::clear(void)
 {
 	while (not _frame_stack.empty()) _frame_stack.pop();
-	while (not _odo_sections.empty()) _odo_sections.pop();
 	while (not _odo_stack.empty()) _odo_stack.pop();
+	_trail.clear();
+	_created.clear();
+	_pinned.clear();
 
 	_frame.clear();
 	_odo.clear();
+	_odo_base = 0;
+	_found = false;
+
+	_memo.reset(_cb->memo_size);
+	_num_solved = 0;
+	_num_spawned = 0;
+	_deadline.start(*_cb);
+	_stats.start();
 
 	_scratch = createAtomSpace(_as);
 	_cb->clear(_scratch.get());
@@ -64,51 +91,189 @@ void Aggregate::clear(void)
 ///
 void Aggregate::aggregate(const HandleSet& nuclei,
                           GenerateCallback& cb)
+{
+	start(nuclei, cb);
+	while (advance()) {}
+	_stats.scratch_atoms = _scratch->get_size();
+	_stats.stop();
+	_stats.print();
+
+	if (_memo.enabled())
+		logger().debug("Dead-state table: %lu hits, %lu misses, "
+			"%lu evictions, %lu states",
+			_memo.hits(), _memo.misses(), _memo.evictions(), _memo.size());
+}
+
+/// Set up, so that solutions can be pulled, one at a time, with
+/// `next_solution()`.
+void Aggregate::start(const HandleSet& nuclei,
+                      GenerateCallback& cb)
 {
 	_cb = &cb;
 	clear();
-
-	// Set it up and go.
+	_in_root = false;
 	_cb->root_set(nuclei);
+}
+
+/// Return the next solution, as a SetLink of sections, or the
+/// undefined handle, if there are no more. The search is suspended
+/// after each solution, and is resumed on the next call.
+Handle Aggregate::next_solution(void)
+{
+	bool found = advance();
+	_stats.scratch_atoms = _scratch->get_size();
+	_stats.stop();
+	if (not found) return Handle::UNDEFINED;
+
+	HandleSeq sects(_frame._linkage.begin(), _frame._linkage.end());
+	return createLink(std::move(sects), SET_LINK);
+}
+
+/// Run the search until the next solution is found (and return true)
+/// or until there are no more roots to explore (and return false).
+bool Aggregate::advance(void)
+{
 	while (true)
 	{
-		HandleSet starters = _cb->next_root();
-		if (starters.size() == 0) break;
-
-		push_frame();
-		for (const Handle& sect : starters)
+		if (not _in_root)
 		{
-			_frame._open_sections.insert(sect);
+			// Out of time, or cancelled; the solutions so far stand.
+			if (_deadline.expired()) return false;
+
+			HandleSet starters = _cb->next_root();
+			if (starters.size() == 0) return false;
+
+			push_frame();
+			for (const Handle& sect : starters)
+			{
+				frame_insert(_frame._open_sections, sect);
+			}
+			_top = _odo_stack.size();
+			_next = ENTER;
+			_in_root = true;
 		}
-		recurse();
+
+		if (explore()) return true;
+
 		pop_frame();
+		_in_root = false;
 	}
 }
 
-/// Breadth-first recursion.
-/// See the README.md for an explanation.
+/// Breadth-first exploration of everything reachable from the
+/// current frame. See the README.md for an explanation.
 void Aggregate::recurse(void)
+{
+	_top = _odo_stack.size();
+	_next = ENTER;
+	while (explore()) {}
+}
+
+/// Breadth-first exploration, with an explicit stack. This is what
+/// a recursive descent would do: on entry to each level, a new
+/// odometer is set up, and each of its states is explored at the
+/// next level down; when the odometer is exhausted, the level
+/// returns to the one above, which steps its own odometer. Here,
+/// the levels are the odometer stack, and `_next` says whether the
+/// next thing to do is to enter a new level, or to step the odometer
+/// at the current one.
+///
+/// Returns true as soon as a new solution is found; calling again
+/// picks up where it left off. Returns false when everything below
+/// the level `_top` has been explored.
+bool Aggregate::explore(void)
+{
+	while (true)
+	{
+		bool more = false;
+		if (ENTER == _next)
+		{
+			more = enter();
+		}
+		else
+		{
+			// Back at the level we started at; we are done.
+			if (_top == _odo_stack.size()) return false;
+
+			// Exploration is done, step to the next state.
+			more = step_odometer();
+			GEN_TRACE(EXPLORED, _odo_stack.size(), more);
+			if (not more) pop_odo();
+		}
+
+		// If we are here, and have more, we have a valid odo state.
+		// Explore it, or, if there are idle threads, let one of them
+		// explore it. The exploration is self-contained: it leaves
+		// behind no state, and so can be done anywhere.
+		_next = STEP;
+		if (more and not _redundant)
+		{
+			if (_pool and 0 < _frame._open_sections.size() and
+			    _pool->want_work())
+			{
+				_pool->spawn(_pool_id, _frame, odo_depth());
+				_num_spawned ++;
+			}
+			else
+				_next = ENTER;
+		}
+
+		if (_found)
+		{
+			_found = false;
+			return true;
+		}
+	}
+}
+
+/// Enter a new level: initialize a brand-new odometer, and take the
+/// first step. Returns false if there is nothing to do at this level.
+bool Aggregate::enter(void)
 {
 	// Nothing to do.
-	if (0 == _frame._open_sections.size()) return;
+	if (0 == _frame._open_sections.size()) return false;
+
+	// Out of time, or cancelled.
+	if (_deadline.expired()) return false;
+
+	// Cannot be finished within the limits.
+	if (not _cb->viable(_frame))
+	{
+		GEN_TRACE(NOT_VIABLE, _odo_stack.size());
+		return false;
+	}
+
+	// Been here before (by some other route) and got nowhere.
+	std::string key;
+	if (_memo.enabled())
+	{
+		key = memo_key();
+		if (_memo.find(key))
+		{
+			GEN_TRACE(DEAD_STATE, _odo_stack.size());
+			return false;
+		}
+	}
 
 	// Halt recursion, if need be.
 	if (not _cb->step(_frame))
 	{
-		logger().fine("Recursion halted at frame depth=%lu odo level=%lu",
-			_frame_stack.size(), _odo_stack.size());
-		return;
+		GEN_TRACE(HALTED, _odo_stack.size(), _frame_stack.size());
+		return false;
 	}
 
-	logger().fine("Enter recurse");
+	GEN_TRACE(ENTER, _odo_stack.size(), _frame_stack.size());
 
 	// Initialize a brand-new odometer at the next recursion level.
 	push_odo();
+	_odo._memo_key = std::move(key);
+	_odo._memo_solved = _num_solved;
+	_odo._memo_spawned = _num_spawned;
 	bool more = init_odometer();
 	if (not more)
 	{
 		pop_odo();
-		return;
+		return false;
 	}
 
 	// Take the first step.
@@ -116,26 +281,9 @@ void Aggregate::recurse(void)
 	more = do_step();
 	_odo._step = _odo._size-1;
 
-	logger().fine("Recurse: After first step, have-more=%d", more);
-	while (true)
-	{
-		// Odometer is exhausted; we are done.
-		if (not more)
-		{
-			pop_odo();
-			return;
-		}
-
-		// If we are here, we have a valid odo state. Explore it.
-		recurse();
-		logger().fine("Returned from recurse");
-
-		// Exploration is done, step to the next state.
-		more = step_odometer();
-		logger().fine("Recurse: After next step, have-more=%d", more);
-	}
-
-	return; // *not-reached*
+	GEN_TRACE(ENTERED, _odo_stack.size(), more);
+	if (not more) pop_odo();
+	return more;
 }
 
 /// Initialize the odometer state. This creates an ordered list of
@@ -148,6 +296,12 @@ bool Aggregate::init_odometer(void)
 	_odo._from_index.clear();
 	_odo._to_connectors.clear();
 	_odo._sections.clear();
+	_odo._point_wheels.clear();
+	_odo._picks.clear();
+	_odo._con_runs.clear();
+	_odo._sect_runs.clear();
+	_odo._explored.clear();
+	_odo._twinned = false;
 
 	// Loop over all open connectors
 	for (const Handle& sect: _frame._open_sections)
@@ -164,11 +318,14 @@ bool Aggregate::init_odometer(void)
 
 			// Get a list of connectors that can be connected to.
 			// If none, then this connector can never be closed.
-			HandleSeq to_cons = _cb->joints(from_con);
+			const HandleSeq& to_cons = _cb->joints(from_con);
 			if (0 == to_cons.size()) return false;
 
+			std::vector<size_t>& wheels =
+				_odo._point_wheels[sect->getOutgoingAtom(0)];
 			for (const Handle& to_con: to_cons)
 			{
+				wheels.push_back(_odo._sections.size());
 				_odo._sections.push_back(sect);
 				_odo._from_index.push_back(idx);
 				_odo._to_connectors.push_back(to_con);
@@ -180,21 +337,104 @@ bool Aggregate::init_odometer(void)
 	if (0 == _odo._size) return false;
 	_odo._step = 0;
 
-	logger().fine("Initialized odometer of length %lu", _odo._size);
-	_odo.print_odometer(_frame);
+	if (_cb->most_constrained_first)
+		order_wheels();
+
+	if (_cb->break_symmetry)
+	{
+		_odo._picks.resize(_odo._size);
+		find_twins();
+	}
+
+	_stats.odometer(odo_depth(), _odo._size);
+	GEN_TRACE(ODO_INIT, _odo_stack.size(), _odo._size);
+	GEN_TRACE_DO(_odo.print_odometer(_frame));
 
 	return true;
 }
 
+/// Sort the wheels so that those with the fewest choices come first,
+/// and thus turn the slowest. The wheels of a connector stay together,
+/// and so do the connectors of a section: the symmetry breaking works
+/// on such runs. A section is ranked by its most constrained wheel,
+/// a connector likewise, and ties keep the original order.
+void Aggregate::order_wheels(void)
+{
+	size_t nw = _odo._size;
+	std::map<Handle, size_t> choices;
+	std::vector<size_t> nchoice(nw);
+	for (size_t iw = 0; iw < nw; iw++)
+	{
+		const Handle& to_con = _odo._to_connectors[iw];
+		auto fnd = choices.find(to_con);
+		if (choices.end() == fnd)
+			fnd = choices.emplace(to_con,
+				_cb->num_choices(_frame, to_con)).first;
+		nchoice[iw] = fnd->second;
+	}
+
+	// The rank of each wheel: that of its section, then that of its
+	// connector, then its own.
+	struct Rank { size_t sect, sord, con, cord, wheel, iw; };
+	std::vector<Rank> ranks(nw);
+	size_t sbeg = 0, sord = 0;
+	while (sbeg < nw)
+	{
+		size_t send = sbeg;
+		size_t smin = SIZE_MAX;
+		while (send < nw and _odo._sections[send] == _odo._sections[sbeg])
+			smin = std::min(smin, nchoice[send++]);
+
+		size_t cbeg = sbeg, cord = 0;
+		while (cbeg < send)
+		{
+			size_t cend = cbeg;
+			size_t cmin = SIZE_MAX;
+			while (cend < send and
+			       _odo._from_index[cend] == _odo._from_index[cbeg])
+				cmin = std::min(cmin, nchoice[cend++]);
+
+			for (size_t iw = cbeg; iw < cend; iw++)
+				ranks[iw] = {smin, sord, cmin, cord, nchoice[iw], iw};
+			cbeg = cend;
+			cord++;
+		}
+		sbeg = send;
+		sord++;
+	}
+
+	std::sort(ranks.begin(), ranks.end(),
+		[](const Rank& a, const Rank& b) {
+			return std::tie(a.sect, a.sord, a.con, a.cord, a.wheel, a.iw) <
+			       std::tie(b.sect, b.sord, b.con, b.cord, b.wheel, b.iw);
+		});
+
+	HandleSeq sections, to_cons;
+	std::vector<size_t> from_index;
+	_odo._point_wheels.clear();
+	for (const Rank& rk : ranks)
+	{
+		const Handle& sect = _odo._sections[rk.iw];
+		_odo._point_wheels[sect->getOutgoingAtom(0)].push_back(sections.size());
+		sections.push_back(sect);
+		from_index.push_back(_odo._from_index[rk.iw]);
+		to_cons.push_back(_odo._to_connectors[rk.iw]);
+	}
+	_odo._sections.swap(sections);
+	_odo._from_index.swap(from_index);
+	_odo._to_connectors.swap(to_cons);
+}
+
 bool Aggregate::do_step(void)
 {
+	_redundant = false;
+
 	// Erase the last connection that was made.
 	if (_frame._wheel == _odo._step and
-	    _frame._nodo == _odo_stack.size()) pop_frame();
+	    _frame._nodo == odo_depth()) pop_frame();
 
-	logger().fine("Step odometer wheel %lu of %lu at depth %lu",
-	               _odo._step, _odo._size, _odo_stack.size());
-	_odo.print_odometer(_frame);
+	GEN_TRACE(ODO_STEP, _odo_stack.size(), _odo._step, _odo._size);
+	GEN_TRACE_DO(_odo.print_odometer(_frame));
 
 	// Draw a new piece via callback, and attach it.
 	bool did_step = false;
@@ -209,9 +449,10 @@ bool Aggregate::do_step(void)
 		// Is there an open connector at this location?
 		if (fm_con->get_type() != CONNECTOR)
 		{
-			logger().fine("Wheel-con not open: %lu of %lu at depth %lu",
-			               ic, _odo._size, _odo_stack.size());
-			_odo.print_wheel(_frame, ic);
+			GEN_TRACE(WHEEL_CLOSED, _odo_stack.size(), ic, _odo._size);
+			GEN_TRACE_DO(_odo.print_wheel(_frame, ic));
+			if (_cb->break_symmetry)
+				_odo._picks[ic]._kind = Odometer::SKIPPED;
 
 			if (ic == _odo._step)
 			{
@@ -228,12 +469,13 @@ bool Aggregate::do_step(void)
 		// If we made it to here, then the to-connector is still free.
 		// Draw a new section to connect to it.
 		Handle to_sect = _cb->select(_frame, fm_sect, offset, to_con);
+		_stats.selects ++;
 
 		if (nullptr == to_sect)
 		{
-			logger().fine("Rolled over wheel %lu of %lu at depth %lu",
-			               ic, _odo._size, _odo_stack.size());
-			_odo.print_wheel(_frame, ic);
+			_stats.null_selects ++;
+			GEN_TRACE(WHEEL_ROLLOVER, _odo_stack.size(), ic, _odo._size);
+			GEN_TRACE_DO(_odo.print_wheel(_frame, ic));
 
 			// If we are here, then this wheel has rolled over.
 			// That means that it's time for the previous wheel
@@ -243,6 +485,7 @@ bool Aggregate::do_step(void)
 		}
 
 		did_step = true;
+		if (_cb->break_symmetry) record_pick(ic, to_sect);
 		push_frame();
 		_frame._wheel = ic;
 
@@ -250,17 +493,14 @@ bool Aggregate::do_step(void)
 		HandlePair hpr = connect_section(fm_sect, offset, to_sect, to_con);
 
 		// Replace the from-section with the now-connected section.
-		for (size_t in = 0; in < _odo._size; in++)
-		{
-			if (*_odo._sections[in] == *fm_sect) _odo._sections[in] = hpr.first;
-			if (*_odo._sections[in] == *to_sect) _odo._sections[in] = hpr.second;
-		}
+		// Likewise the to-section, if it is on the odometer.
+		replace_section(fm_sect, hpr.first);
+		replace_section(to_sect, hpr.second);
 	}
 
 	if (not did_step)
 	{
-		logger().fine("Did not step wheel: %lu of %lu at depth %lu",
-			               _odo._step, _odo._size, _odo_stack.size());
+		GEN_TRACE(NO_STEP, _odo_stack.size(), _odo._step, _odo._size);
 		if (0 < _odo._step) _odo._step --;
 		return false;
 	}
@@ -268,28 +508,53 @@ bool Aggregate::do_step(void)
 	// Next time, we will turn just the last wheel.
 	_odo._step = _odo._size - 1;
 
-	logger().fine("Stepped odo: open-points=%lu open-sect=%lu lkg=%lu",
-		_frame._open_points.size(), _frame._open_sections.size(),
-		_frame._linkage.size());
+	GEN_TRACE(ODO_STEPPED, _odo_stack.size(),
+		_frame._open_sections.size(), _frame._linkage.size());
+
+	// Symmetric to a state that was already explored; skip it.
+	if (_odo._twinned and redundant())
+	{
+		GEN_TRACE(REDUNDANT, _odo_stack.size());
+		_redundant = true;
+		return true;
+	}
 
 	// If we found a solution, let the callback accumulate it.
+	// Callbacks that count their solutions can say that this one
+	// is not new; those that don't are taken at their word.
 	if (0 == _frame._open_sections.size())
+	{
+		_num_solved ++;
+		size_t before = _cb->num_solutions();
 		_cb->solution(_frame);
+		size_t after = _cb->num_solutions();
+		_found = (before != after) or (0 == after);
+		_stats.solution(_found);
+
+		// Keep the solution, when frames are popped.
+		if (_found and _reclaim)
+			_pinned.insert(_frame._linkage.begin(), _frame._linkage.end());
+	}
 
 	return true;
 }
 
 bool Aggregate::step_odometer(void)
 {
+	if (_deadline.expired()) return false;
+
 	if (not _cb->step(_frame))
 	{
-		logger().fine("Odometer halted at frame depth=%lu odo stack=%lu",
-			_frame_stack.size(), _odo_stack.size());
+		GEN_TRACE(HALTED, _odo_stack.size(), _frame_stack.size());
 		return false;
 	}
 
 	// Total rollover
-	if (_odo._size < _odo._step) return false;
+	if (_odo._size < _odo._step)
+	{
+		_stats.rollovers ++;
+		return false;
+	}
 
 	// Take a step.
 	bool did_step = do_step();
@@ -298,10 +563,11 @@ bool Aggregate::step_odometer(void)
 		// If the stepper rolled over to minus-one, then we're done.
 		if (SIZE_MAX == _odo._step)
 		{
-			logger().fine("Exhaused the odometer at depth %lu", _odo_stack.size());
+			_stats.rollovers ++;
+			GEN_TRACE(EXHAUSTED, _odo_stack.size());
 			return false;
 		}
-		logger().fine("Failed to step, try wheel %lu", _odo._step);
+		GEN_TRACE(RETRY, _odo_stack.size(), _odo._step);
 
 		did_step = do_step();
 	}
@@ -309,6 +575,212 @@ bool Aggregate::step_odometer(void)
 	return did_step;
 }
 
+// ---------------------------------------------------------------
+// Symmetry breaking.
+//
+// Two runs of wheels are interchangeable if there is a symmetry of
+// the current frame that swaps them: two identical open connectors on
+// the same section, or two open sections that are twins: same point,
+// same connectors, and linked to the same neighbors. Given one state
+// of the odometer, swapping what the two runs attached to gives
+// another state, and the networks that can be grown from the two are
+// the same, up to the naming of the points. Thus, only the first of
+// them to be reached needs to be explored.
+//
+// To find out if an equivalent state was already explored, each state
+// is given a key, listing what each wheel attached to, with the
+// interchangeable runs put into sorted order. Only runs that drew
+// new sections from the lexis for all of their connectors are sorted.
+// Runs that attached to open sections, or that were attached to, are
+// left in place, since swapping them would change what other wheels
+// are attached to. Likewise, states in which a wheel attached to a
+// section drawn by another wheel, in the same step, are not keyed.
+//
+// Note that the order of the connectors in a section is ignored
+// here: two identical connectors are taken to be interchangeable.
+// This is correct for graphs, but not for e.g. Link Grammar, where
+// connector order is word order.
+
+/// Group the odometer wheels into runs, and find the classes of
+/// interchangeable runs.
+void Aggregate::find_twins(void)
+{
+	// Key for twin sections: the point (less the uuid) and, for
+	// each connector, either the connector, or the link type and
+	// the point at the far end.
+	typedef std::pair<std::string, HandleSeq> TwinKey;
+	std::map<TwinKey, size_t> twins;
+
+	size_t ic = 0;
+	while (ic < _odo._size)
+	{
+		const Handle& sect = _odo._sections[ic];
+		const Handle& point = sect->getOutgoingAtom(0);
+		const HandleSeq& conseq = sect->getOutgoingAtom(1)->getOutgoingSet();
+
+		// Runs for the connectors of this section. The class of
+		// a connector run is the run number of the first identical
+		// connector.
+		std::map<Handle, size_t> cons;
+		size_t first = _odo._con_runs.size();
+		while (ic < _odo._size and _odo._sections[ic] == sect)
+		{
+			size_t begin = ic;
+			size_t idx = _odo._from_index[ic];
+			while (ic < _odo._size and _odo._sections[ic] == sect and
+			       _odo._from_index[ic] == idx) ic++;
+
+			auto cit = cons.emplace(conseq[idx], _odo._con_runs.size());
+			_odo._con_runs.push_back({begin, ic, cit.first->second});
+			if (not cit.second) _odo._twinned = true;
+		}
+
+		TwinKey key(std::to_string(point->get_type()) + ":" +
+			Canonical::base_name(point->get_name()), HandleSeq());
+		for (const Handle& con : conseq)
+		{
+			if (CONNECTOR == con->get_type())
+			{
+				key.second.push_back(con);
+				continue;
+			}
+			key.second.push_back(con->getOutgoingAtom(0));
+			Handle far(point);
+			for (const Handle& end : con->getOutgoingAtom(1)->getOutgoingSet())
+				if (end != point) far = end;
+			key.second.push_back(far);
+		}
+
+		auto sit = twins.emplace(key, _odo._sect_runs.size());
+		_odo._sect_runs.push_back({first, _odo._con_runs.size(),
+		                           sit.first->second});
+		if (not sit.second) _odo._twinned = true;
+	}
+}
+
+/// Record what wheel `ic` attached to.
+void Aggregate::record_pick(size_t ic, const Handle& to_sect)
+{
+	Odometer::Pick& pick = _odo._picks[ic];
+	const Handle& point = to_sect->getOutgoingAtom(0);
+	if (0 < _frame._open_sections.count(to_sect))
+	{
+		pick._kind = Odometer::OPENED;
+		pick._point = point;
+		return;
+	}
+	pick._kind = Odometer::DRAWN;
+	pick._name = Canonical::base_name(point->get_name());
+	pick._disj = to_sect->getOutgoingAtom(1);
+}
+
+/// Sort the keys of the runs that drew all of their sections, among
+/// the positions of the runs in the same class.
+static void sort_runs(const std::vector<Odometer::Run>& runs,
+                      std::vector<std::string>& keys,
+                      const std::vector<bool>& drawn)
+{
+	std::map<size_t, std::vector<size_t>> classes;
+	for (size_t ir = 0; ir < runs.size(); ir++)
+		if (drawn[ir]) classes[runs[ir]._class].push_back(ir);
+
+	for (const auto& cls : classes)
+	{
+		if (cls.second.size() < 2) continue;
+		std::vector<std::string> sorted;
+		for (size_t ir : cls.second) sorted.push_back(keys[ir]);
+		std::sort(sorted.begin(), sorted.end());
+		for (size_t i = 0; i < sorted.size(); i++)
+			keys[cls.second[i]] = sorted[i];
+	}
+}
+
+/// Return true if a state equivalent to the current odometer state
+/// has already been explored.
+bool Aggregate::redundant(void)
+{
+	// Key for each connector run.
+	size_t ncr = _odo._con_runs.size();
+	std::vector<std::string> ckeys(ncr);
+	std::vector<bool> cdrawn(ncr);
+	for (size_t ir = 0; ir < ncr; ir++)
+	{
+		const Odometer::Run& run = _odo._con_runs[ir];
+		std::string& key = ckeys[ir];
+		bool drawn = false;
+		bool fixed = false;
+		for (size_t ic = run._begin; ic < run._end; ic++)
+		{
+			const Odometer::Pick& pick = _odo._picks[ic];
+			if (Odometer::SKIPPED == pick._kind)
+			{
+				key += "s";
+				continue;
+			}
+			if (Odometer::OPENED == pick._kind)
+			{
+				// Attached to a section drawn in this very step.
+				if (0 == _odo._point_wheels.count(pick._point))
+					return false;
+				key += "o" + std::to_string((uintptr_t) pick._point.get()) + ",";
+				fixed = true;
+				continue;
+			}
+			key += "d" + std::to_string(pick._name.size()) + ":" +
+				pick._name + std::to_string((uintptr_t) pick._disj.get()) + ",";
+			drawn = true;
+		}
+		key += ";";
+		cdrawn[ir] = drawn and not fixed;
+	}
+	sort_runs(_odo._con_runs, ckeys, cdrawn);
+
+	// Key for each section run.
+	size_t nsr = _odo._sect_runs.size();
+	std::vector<std::string> skeys(nsr);
+	std::vector<bool> sdrawn(nsr, true);
+	for (size_t ir = 0; ir < nsr; ir++)
+	{
+		const Odometer::Run& run = _odo._sect_runs[ir];
+		for (size_t icr = run._begin; icr < run._end; icr++)
+		{
+			skeys[ir] += ckeys[icr];
+			if (not cdrawn[icr]) sdrawn[ir] = false;
+		}
+		skeys[ir] += "|";
+	}
+	sort_runs(_odo._sect_runs, skeys, sdrawn);
+
+	std::string key;
+	for (const std::string& sk : skeys) key += sk;
+	return not _odo._explored.insert(key).second;
+}
+
+// ---------------------------------------------------------------
+// Dead states.
+//
+// The same set of open sections is often reached more than once: the
+// wheels of an odometer attach the same pieces in a different order,
+// or two odometer states lead to the same place one level down. If
+// nothing could be completed from there the first time, then there
+// is no point in trying again. The key for the dead-state table is
+// the canonical form of the open sections (see `Canonical`), so that
+// the naming of the points does not matter, together with whatever
+// the limits in `GenerateCallback::step()` depend on.
+
+/// Key for the current frame, for the dead-state table.
+std::string Aggregate::memo_key(void)
+{
+	std::string key;
+	if (SIZE_MAX != _cb->max_depth)
+		key += std::to_string(odo_depth());
+	key += ",";
+	if (SIZE_MAX != _cb->max_network_size)
+		key += std::to_string(_frame._linkage.size());
+	key += ",";
+	return key + Canonical::open_form(_frame._open_sections);
+}
+
 #define al _as->add_link
 #define an _as->add_node
 
@@ -322,11 +794,9 @@ HandlePair Aggregate::connect_section(const Handle& fm_sect,
                                       const Handle& to_sect,
                                       const Handle& to_con)
 {
-	// logger().fine("Connect %s\nto %s",
-	//	fm_sect->to_string().c_str(), to_sect->to_string().c_str());
-	logger().fine("Connect fm-offset=%lu:", offset);
-	OdoFrame::print_section(fm_sect);
-	OdoFrame::print_section(to_sect);
+	GEN_TRACE(CONNECT, _odo_stack.size(), offset, 0, fm_sect);
+	GEN_TRACE_DO(OdoFrame::print_section(fm_sect);
+		OdoFrame::print_section(to_sect));
 
 	const Handle& fm_point = fm_sect->getOutgoingAtom(0);
 	const Handle& to_point = to_sect->getOutgoingAtom(0);
@@ -337,13 +807,22 @@ HandlePair Aggregate::connect_section(const Handle& fm_sect,
 	Handle link = _cb->make_link(fm_con, to_con, fm_point, to_point);
 
 	// Oh dear, we need the index of the to_con in the to_sect
-	// Perhaps the callback should provide this info?
+	// Perhaps the callback should provide this info? The connector
+	// sequences are short, and the connectors are almost always the
+	// very same atoms, so try a cheap pointer compare first.
 	const Handle& disj = to_sect->getOutgoingAtom(1);
 	const HandleSeq& tseq = disj->getOutgoingSet();
 	size_t tidx = -1;
 	for (size_t i=0; i<tseq.size(); i++)
 	{
-		if (*to_con == *tseq[i]) { tidx = i; break; }
+		if (to_con == tseq[i]) { tidx = i; break; }
+	}
+	if (SIZE_MAX == tidx)
+	{
+		for (size_t i=0; i<tseq.size(); i++)
+		{
+			if (*to_con == *tseq[i]) { tidx = i; break; }
+		}
 	}
 
 	Handle new_fm = make_link(fm_sect, offset, link);
@@ -382,63 +861,146 @@ Handle Aggregate::make_link(const Handle& sect, size_t index,
 
 	// Create the now-connected linkage. Create it in the scratch
 	// space, so as not to pollute the main space.
-	Handle linking =
-		_scratch->add_link(SECTION, point,
-			_scratch->add_link(CONNECTOR_SEQ, std::move(oset)));
+	Handle seq = _scratch->add_link(CONNECTOR_SEQ, std::move(oset));
+	Handle linking = _scratch->add_link(SECTION, point, seq);
+	if (_reclaim)
+	{
+		_created.push_back(seq);
+		_created.push_back(linking);
+	}
 
 	// Remove the section from the open set.
-	_frame._open_sections.erase(sect);
+	frame_erase(_frame._open_sections, sect);
 
 	// If the connected section has remaining unconnected connectors,
 	// then add it to the unfinished set. Else we are done with it.
 	if (is_open)
 	{
-		_frame._open_sections.insert(linking);
-		_frame._open_points.insert(point);
-		logger().fine("---- Open point %s", point->to_string().c_str());
+		frame_insert(_frame._open_sections, linking);
+		frame_insert(_frame._open_points, point);
+		GEN_TRACE(OPEN_POINT, _odo_stack.size(), 0, 0, point);
 	}
 	else
 	{
-		_frame._linkage.insert(linking);
-		_frame._open_points.erase(point);
-		logger().fine("---- Close point %s", point->to_string().c_str());
+		frame_insert(_frame._linkage, linking);
+		frame_erase(_frame._open_points, point);
+		GEN_TRACE(CLOSE_POINT, _odo_stack.size(), 0, 0, point);
 	}
 
 	return linking;
 }
 
+// ---------------------------------------------------------------
+
+/// Insert `h` into one of the sets in the current frame, recording
+/// the change on the undo trail, if there was one.
+void Aggregate::frame_insert(HandleSet& set, const Handle& h)
+{
+	if (set.insert(h).second)
+		_trail.push_back({&set, false, 0, h});
+}
+
+/// Remove `h` from one of the sets in the current frame, recording
+/// the change on the undo trail, if there was one.
+void Aggregate::frame_erase(HandleSet& set, const Handle& h)
+{
+	if (0 < set.erase(h))
+		_trail.push_back({&set, true, 0, h});
+}
+
+/// Replace the odometer section at `index`, recording the old one.
+void Aggregate::set_odo_section(size_t index, const Handle& h)
+{
+	_trail.push_back({nullptr, false, index, _odo._sections[index]});
+	_odo._sections[index] = h;
+}
+
+/// Replace `old_sect` by `new_sect` on all odometer wheels holding it.
+/// Only the wheels for the point of `old_sect` need to be looked at.
+void Aggregate::replace_section(const Handle& old_sect,
+                                const Handle& new_sect)
+{
+	auto pw = _odo._point_wheels.find(old_sect->getOutgoingAtom(0));
+	if (_odo._point_wheels.end() == pw) return;
+
+	for (size_t in : pw->second)
+	{
+		if (*_odo._sections[in] == *old_sect)
+			set_odo_section(in, new_sect);
+	}
+}
+
+void Aggregate::undo(const Change& chg)
+{
+	if (nullptr == chg._set)
+		_odo._sections[chg._index] = chg._atom;
+	else if (chg._erased)
+		chg._set->insert(chg._atom);
+	else
+		chg._set->erase(chg._atom);
+}
+
 void Aggregate::push_frame(void)
 {
 	_cb->push_frame(_frame);
-	_frame_stack.push(_frame);
-	_odo_sections.push(_odo._sections);
-	_frame._nodo = _odo_stack.size();
+	_stats.frame_pushes ++;
+	_frame_stack.push({_trail.size(), _created.size(),
+		_frame._nodo, _frame._wheel});
+	_frame._nodo = odo_depth();
 	_frame._wheel = -1;
 
-	logger().fine("---- Push: Frame stack depth now %lu npts=%lu open=%lu lkg=%lu",
-	     _frame_stack.size(), _frame._open_points.size(),
-	     _frame._open_sections.size(), _frame._linkage.size());
+	GEN_TRACE(FRAME_PUSH, _odo_stack.size(),
+		_frame_stack.size(), _frame._open_sections.size());
 }
 
 void Aggregate::pop_frame(void)
 {
+	const FrameMark& mark = _frame_stack.top();
+
+	// Our own atoms go first; they hold on to the points and links
+	// that the callback will be reclaiming.
+	reclaim(mark._created);
 	_cb->pop_frame(_frame);
-	_frame = _frame_stack.top(); _frame_stack.pop();
-	_odo._sections = _odo_sections.top(); _odo_sections.pop();
 
-	logger().fine("---- Pop: Frame stack depth now %lu npts=%lu open=%lu lkg=%lu",
-	     _frame_stack.size(), _frame._open_points.size(),
-	     _frame._open_sections.size(), _frame._linkage.size());
-	_frame.print();
+	while (mark._trail < _trail.size())
+	{
+		undo(_trail.back());
+		_trail.pop_back();
+	}
+	_frame._nodo = mark._nodo;
+	_frame._wheel = mark._wheel;
+	_frame_stack.pop();
+
+	GEN_TRACE(FRAME_POP, _odo_stack.size(),
+		_frame_stack.size(), _frame._open_sections.size());
+	GEN_TRACE_DO(_frame.print());
+}
+
+/// Remove the atoms created since the frame mark `mark` from the
+/// scratch space, newest first. Sections of recorded solutions stay,
+/// and so does anything that is still referenced; removal fails for
+/// atoms with a non-empty incoming set. Nothing else needs the
+/// sections of a frame being popped: its undo puts back the sections
+/// that they replaced.
+void Aggregate::reclaim(size_t mark)
+{
+	while (mark < _created.size())
+	{
+		const Handle& h = _created.back();
+		if (0 == _pinned.count(h))
+			_scratch->remove_atom(h);
+		_created.pop_back();
+	}
 }
 
 /// Push the odometer state.
 void Aggregate::push_odo(void)
 {
 	_cb->push_odometer(_odo);
-	_odo_stack.push(_odo);
+	_stats.odo_pushes ++;
+	_odo_stack.push(std::move(_odo));
 
-	logger().fine("==== Push: Odo stack depth now %lu", _odo_stack.size());
+	GEN_TRACE(ODO_PUSH, _odo_stack.size());
 
 	_odo._frame_depth = _frame_stack.size();
 }
@@ -448,10 +1010,17 @@ void Aggregate::pop_odo(void)
 	// Realign the frame stack to where we started.
 	while (_odo._frame_depth < _frame_stack.size()) pop_frame();
 
+	// Nothing below this odometer led anywhere; remember that.
+	if (not _odo._memo_key.empty() and
+	    _odo._memo_solved == _num_solved and
+	    _odo._memo_spawned == _num_spawned)
+		_memo.insert(_odo._memo_key);
+
 	_cb->pop_odometer(_odo);
-	_odo = _odo_stack.top(); _odo_stack.pop();
+	_stats.odo_pops ++;
+	_odo = std::move(_odo_stack.top()); _odo_stack.pop();
 
-	logger().fine("==== Pop: Odo stack depth now %lu", _odo_stack.size());
+	GEN_TRACE(ODO_POP, _odo_stack.size());
 }
 
 // ========================== END OF FILE ==========================
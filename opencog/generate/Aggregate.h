@@ -23,10 +23,15 @@
 #define _OPENCOG_AGGREGATE_H
 
 #include <set>
+#include <stack>
+#include <vector>
 
 #include <opencog/atomspace/AtomSpace.h>
+#include <opencog/generate/AggregateStats.h>
+#include <opencog/generate/Deadline.h>
 #include <opencog/generate/Odometer.h>
 #include <opencog/generate/GenerateCallback.h>
+#include <opencog/generate/TranspositionTable.h>
 
 namespace opencog
 {
@@ -34,8 +39,13 @@ namespace opencog
  *  @{
  */
 
+class ParallelAggregate;
+class PopulationAggregate;
+
 class Aggregate
 {
+	friend class ParallelAggregate;
+	friend class PopulationAggregate;
 private:
 	AtomSpace* _as;
 	AtomSpacePtr _scratch;
@@ -43,25 +53,105 @@ private:
 	/// Decision-maker
 	GenerateCallback* _cb;
 
+	/// Wall-clock limit and cancellation.
+	Deadline _deadline;
+	AggregateStats _stats;
+
 	/// Current traversal state
 	OdoFrame _frame;
 	Odometer _odo;
 
-	std::stack<OdoFrame> _frame_stack;
-	std::stack<HandleSeq> _odo_sections;
+	/// Undo trail. Rather than copying the entire frame (and the
+	/// odometer sections) on every push, only the changes made since
+	/// the last push are recorded; pop undoes them, in reverse order.
+	/// A change is either an insertion into, or removal from, one of
+	/// the sets in `_frame`, or the replacement of an entry in
+	/// `_odo._sections`. The latter is indicated by a null `_set`.
+	struct Change
+	{
+		HandleSet* _set;
+		bool _erased;
+		size_t _index;
+		Handle _atom;
+	};
+	std::vector<Change> _trail;
+
+	void frame_insert(HandleSet&, const Handle&);
+	void frame_erase(HandleSet&, const Handle&);
+	void set_odo_section(size_t, const Handle&);
+	void replace_section(const Handle&, const Handle&);
+	void undo(const Change&);
+
+	/// What is left to remember on a frame push: the length of the
+	/// undo trail, the number of atoms created so far, and the frame
+	/// position.
+	struct FrameMark
+	{
+		size_t _trail;
+		size_t _created;
+		size_t _nodo;
+		size_t _wheel;
+	};
+	std::stack<FrameMark> _frame_stack;
 	void push_frame();
 	void pop_frame();
 
+	/// Atoms that `make_link()` added to the scratch space, in the
+	/// order of creation. When a frame is popped, those created since
+	/// it was pushed are removed again, unless they are part of a
+	/// recorded solution (are pinned), or are still in use. Without
+	/// this, the scratch space holds every section ever tried.
+	/// Off when frames outlive their pop: when the scratch space is
+	/// shared with other threads, or frames are kept in a population.
+	bool _reclaim;
+	HandleSeq _created;
+	HandleSet _pinned;
+	void reclaim(size_t);
+
 	std::stack<Odometer> _odo_stack;
 	void push_odo();
 	void pop_odo();
 
+	/// Odometer depth at which exploration started. This is zero,
+	/// unless exploring a subtree handed over by another thread.
+	size_t _odo_base;
+	size_t odo_depth(void) const { return _odo_base + _odo_stack.size(); }
+
+	/// Work-sharing pool, if any. Frames that could be explored are
+	/// offered to the pool, when other threads are idle.
+	ParallelAggregate* _pool;
+	size_t _pool_id;
+
 	void clear(void);
 
+	/// Dead states: sets of open sections from which no solution
+	/// was reached. The counts are of the solutions reached and the
+	/// subtrees handed off; a subtree is dead if neither changed
+	/// while exploring it.
+	TranspositionTable _memo;
+	size_t _num_solved;
+	size_t _num_spawned;
+	std::string memo_key(void);
+
+	bool _redundant;
+	void find_twins(void);
+	void record_pick(size_t, const Handle&);
+	bool redundant(void);
+
 	bool init_odometer(void);
+	void order_wheels(void);
 	bool step_odometer(void);
 	bool do_step(void);
 
+	/// Explicit-stack exploration; see `explore()`.
+	enum Next { ENTER, STEP };
+	Next _next;
+	size_t _top;
+	bool _found;
+	bool _in_root;
+	bool enter(void);
+	bool explore(void);
+	bool advance(void);
 	void recurse(void);
 
 	HandlePair connect_section(const Handle&, size_t,
@@ -74,6 +164,15 @@ public:
 
 	void aggregate(const HandleSet&, GenerateCallback&);
 
+	/// Same as `aggregate()`, but one solution at a time.
+	void start(const HandleSet&, GenerateCallback&);
+	Handle next_solution(void);
+
+	/// The dead-state table, for its hit and miss counts.
+	const TranspositionTable& memo(void) const { return _memo; }
+
+	/// Statistics of the current (or the last) search.
+	const AggregateStats& stats(void) const { return _stats; }
 };
 
 
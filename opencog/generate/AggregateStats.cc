@@ -0,0 +1,110 @@
+/*
+ * opencog/generate/AggregateStats.cc
+ *
+ * Copyright (C) 2020 Linas Vepstas <linasvepstas@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+
+#include <opencog/util/Logger.h>
+
+#include "AggregateStats.h"
+
+using namespace opencog;
+
+/// Zero everything, and start the clock.
+void AggregateStats::start(void)
+{
+	*this = AggregateStats();
+	started = Clock::now();
+}
+
+void AggregateStats::stop(void)
+{
+	elapsed = std::chrono::duration<double>(Clock::now() - started).count();
+}
+
+/// Record an odometer of `nwheels` wheels, set up at `depth`.
+void AggregateStats::odometer(size_t depth, size_t nwheels)
+{
+	if (depth_odometers.size() <= depth)
+	{
+		depth_odometers.resize(depth+1, 0);
+		depth_wheels.resize(depth+1, 0);
+	}
+	depth_odometers[depth] ++;
+	depth_wheels[depth] += nwheels;
+	max_depth = std::max(max_depth, depth);
+}
+
+void AggregateStats::solution(bool is_new)
+{
+	if (not is_new)
+	{
+		rediscoveries ++;
+		return;
+	}
+	if (0 == solutions)
+		first_solution =
+			std::chrono::duration<double>(Clock::now() - started).count();
+	solutions ++;
+}
+
+void AggregateStats::merge(const AggregateStats& other)
+{
+	odo_pushes += other.odo_pushes;
+	odo_pops += other.odo_pops;
+	frame_pushes += other.frame_pushes;
+	selects += other.selects;
+	null_selects += other.null_selects;
+	rollovers += other.rollovers;
+	solutions += other.solutions;
+	rediscoveries += other.rediscoveries;
+	max_depth = std::max(max_depth, other.max_depth);
+	scratch_atoms += other.scratch_atoms;
+
+	if (0.0 <= other.first_solution and
+	    (first_solution < 0.0 or other.first_solution < first_solution))
+		first_solution = other.first_solution;
+	elapsed = std::max(elapsed, other.elapsed);
+
+	if (depth_odometers.size() < other.depth_odometers.size())
+	{
+		depth_odometers.resize(other.depth_odometers.size(), 0);
+		depth_wheels.resize(other.depth_wheels.size(), 0);
+	}
+	for (size_t d = 0; d < other.depth_odometers.size(); d++)
+	{
+		depth_odometers[d] += other.depth_odometers[d];
+		depth_wheels[d] += other.depth_wheels[d];
+	}
+}
+
+void AggregateStats::print(void) const
+{
+	logger().debug("Search stats: %lu solutions (%lu seen before), "
+		"first after %g secs, %g secs in all",
+		solutions, rediscoveries, first_solution, elapsed);
+	logger().debug("Search stats: odometers %lu pushed, %lu popped, "
+		"%lu run out; %lu frames; %lu selects, %lu empty; max depth %lu; "
+		"%lu scratch atoms",
+		odo_pushes, odo_pops, rollovers, frame_pushes,
+		selects, null_selects, max_depth, scratch_atoms);
+}
+
+// ========================== END OF FILE ==========================
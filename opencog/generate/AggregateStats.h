@@ -0,0 +1,97 @@
+/*
+ * opencog/generate/AggregateStats.h
+ *
+ * Copyright (C) 2020 Linas Vepstas <linasvepstas@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_AGGREGATE_STATS_H
+#define _OPENCOG_AGGREGATE_STATS_H
+
+#include <chrono>
+#include <vector>
+
+namespace opencog
+{
+/** \addtogroup grp_generate
+ *  @{
+ */
+
+/// Search statistics. These are kept by the aggregators at all times;
+/// they are plain counters, and cost next to nothing, unlike logging.
+/// They are meant for tuning the limits and the parameters of a
+/// search (`max_depth`, `close_fraction` and so on) from data.
+struct AggregateStats
+{
+	typedef std::chrono::steady_clock Clock;
+
+	/// Odometers set up and torn down, and frames pushed.
+	size_t odo_pushes = 0;
+	size_t odo_pops = 0;
+	size_t frame_pushes = 0;
+
+	/// Calls to `GenerateCallback::select()`, and how many of these
+	/// returned nothing (that is, how many times a wheel rolled over).
+	size_t selects = 0;
+	size_t null_selects = 0;
+
+	/// Odometers that were run to the end (as opposed to those that
+	/// were stopped, e.g. by `step()` or the deadline).
+	size_t rollovers = 0;
+
+	/// Solutions that were new, and those that the callback had seen
+	/// before (e.g. the same shape, with `dedup_isomorphic`).
+	size_t solutions = 0;
+	size_t rediscoveries = 0;
+
+	/// Deepest odometer depth reached.
+	size_t max_depth = 0;
+
+	/// Seconds from the start of the search to the first solution
+	/// (negative, if there was none), and to the end of the search.
+	double first_solution = -1.0;
+	double elapsed = 0.0;
+
+	/// Atoms in the scratch space at the end of the search: linked
+	/// sections and links, made along the way, including those that
+	/// did not end up in any solution.
+	size_t scratch_atoms = 0;
+
+	/// Histogram, by odometer depth, of the number of odometers set
+	/// up at that depth, and of the total number of wheels on them.
+	/// The ratio is the average size of the odometers at that depth.
+	std::vector<size_t> depth_odometers;
+	std::vector<size_t> depth_wheels;
+
+	Clock::time_point started;
+
+	void start(void);
+	void stop(void);
+	void odometer(size_t depth, size_t nwheels);
+	void solution(bool is_new);
+
+	/// Add in the statistics of another search, e.g. that of another
+	/// thread of the same search.
+	void merge(const AggregateStats&);
+	void print(void) const;
+};
+
+
+/** @}*/
+}  // namespace opencog
+
+#endif // _OPENCOG_AGGREGATE_STATS_H
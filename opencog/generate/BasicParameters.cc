@@ -27,26 +27,25 @@ BasicParameters::BasicParameters()
 {
 	// Try to close existing connectors .. sometimes.
 	close_fraction = 0.3;
+
+	std::random_device seed;
+	_rangen.seed(seed());
 }
 
 BasicParameters::~BasicParameters()
 {}
 
-static std::random_device seed;
-static std::mt19937 rangen(seed());
-
-static inline double uniform_double(void)
-{
-   static std::uniform_real_distribution<> dist(0.0, 1.0);
-   return dist(rangen);
-}
-
 bool BasicParameters::connect_existing(const OdoFrame& frm)
 {
-	return uniform_double() < close_fraction;
+	return _unidist(_rangen) < close_fraction;
 }
 
 bool BasicParameters::step(const OdoFrame& frm)
 {
 	return true;
 }
+
+void BasicParameters::seed(unsigned long s)
+{
+	_rangen.seed(s);
+}
@@ -38,12 +38,18 @@ namespace opencog
 
 class BasicParameters : public RandomParameters
 {
+private:
+	/// Per-instance generator; instances are not shared across threads.
+	std::mt19937 _rangen;
+	std::uniform_real_distribution<> _unidist{0.0, 1.0};
+
 public:
 	BasicParameters();
 	virtual ~BasicParameters();
 
 	virtual bool connect_existing(const OdoFrame&);
 	virtual bool step(const OdoFrame&);
+	virtual void seed(unsigned long);
 
 	/// Fraction of the time that an attempt should be made to join
 	/// together two existing open connectors, if that is possible.
@@ -0,0 +1,302 @@
+/*
+ * opencog/generate/Canonical.cc
+ *
+ * Copyright (C) 2020 Linas Vepstas <linasvepstas@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+
+#include <opencog/atoms/base/Link.h>
+
+#include "Canonical.h"
+
+using namespace opencog;
+
+/// The unique points are made by `LinkStyle::create_unique_point()`,
+/// which appends an `@` and a 36-character uuid to the name.
+std::string Canonical::base_name(const std::string& name)
+{
+	static const size_t UULEN = 36;
+	size_t len = name.size();
+	if (len <= UULEN or '@' != name[len - UULEN - 1]) return name;
+	return name.substr(0, len - UULEN - 1);
+}
+
+/// Rank the strings: return a map from each string to its position
+/// in the sorted list of distinct strings.
+static std::map<std::string, uint32_t>
+rank(const std::vector<std::string>& strs, std::vector<std::string>& sorted)
+{
+	sorted = strs;
+	std::sort(sorted.begin(), sorted.end());
+	sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+	std::map<std::string, uint32_t> ranks;
+	for (size_t i = 0; i < sorted.size(); i++)
+		ranks[sorted[i]] = i;
+	return ranks;
+}
+
+/// Build the graph. Each section is a vertex; each link in its
+/// connector sequence is an edge to the other point in the link.
+/// Every edge is listed in the sections at both ends, and so is
+/// seen twice; this is what we want for the adjacency lists.
+Canonical::Canonical(const HandleSet& linkage, bool open)
+	: _leaves(0)
+{
+	std::map<Handle, uint32_t> vertex;
+	std::vector<std::string> vnames;
+	for (const Handle& sect : linkage)
+	{
+		const Handle& pnt = sect->getOutgoingAtom(0);
+		vertex[pnt] = vnames.size();
+		std::string vname(std::to_string(pnt->get_type()) + ":" +
+		                  base_name(pnt->get_name()));
+
+		// The connectors are atoms, and so are unique; their
+		// addresses will do, to tell them apart.
+		if (open)
+		{
+			for (const Handle& con : sect->getOutgoingAtom(1)->getOutgoingSet())
+				if (CONNECTOR == con->get_type())
+					vname += "," + std::to_string((uintptr_t) con.get());
+		}
+		vnames.push_back(vname);
+	}
+
+	// Collect the edges as (from, label, to) triples, with the label
+	// still a string, until all of them are known.
+	struct Half { uint32_t fm; std::string label; uint32_t to; };
+	std::vector<Half> halves;
+	std::vector<std::string> enames;
+	for (const Handle& sect : linkage)
+	{
+		const Handle& pnt = sect->getOutgoingAtom(0);
+		uint32_t fm = vertex[pnt];
+		for (const Handle& lnk : sect->getOutgoingAtom(1)->getOutgoingSet())
+		{
+			// Unconnected connectors are not edges. There shouldn't
+			// be any, in a solution, but be safe.
+			if (EVALUATION_LINK != lnk->get_type()) continue;
+
+			const Handle& edg = lnk->getOutgoingAtom(1);
+			uint32_t to = fm;
+			bool inside = true;
+			for (const Handle& end : edg->getOutgoingSet())
+			{
+				if (end == pnt) continue;
+				auto fnd = vertex.find(end);
+				if (vertex.end() != fnd) to = fnd->second;
+				else inside = false;
+			}
+			if (open and not inside) continue;
+
+			const Handle& linkty = lnk->getOutgoingAtom(0);
+			std::string label = std::to_string(linkty->get_type()) + ":" +
+				(linkty->is_node() ? linkty->get_name() : linkty->to_string());
+			enames.push_back(label);
+			halves.push_back({fm, label, to});
+		}
+	}
+
+	auto vrank = rank(vnames, _vlabels);
+	for (const std::string& nm : vnames)
+		_vlabel.push_back(vrank[nm]);
+
+	auto erank = rank(enames, _elabels);
+	_adj.resize(vnames.size());
+	for (const Half& h : halves)
+		_adj[h.fm].push_back({erank[h.label], h.to});
+}
+
+/// Re-colour each vertex by its colour together with the multiset of
+/// the (edge label, neighbor colour) pairs around it. The new colours
+/// are the ranks of the sorted signatures, and so do not depend on
+/// the order of the vertexes. Return true if any class was split.
+bool Canonical::rerank(Coloring& col,
+                       std::vector<std::vector<uint32_t>>& sigs) const
+{
+	size_t nv = col.size();
+	for (size_t v = 0; v < nv; v++)
+	{
+		std::vector<std::pair<uint32_t, uint32_t>> nbrs;
+		for (const auto& pr : _adj[v])
+			nbrs.push_back({pr.first, col[pr.second]});
+		std::sort(nbrs.begin(), nbrs.end());
+
+		std::vector<uint32_t>& sig = sigs[v];
+		sig.clear();
+		sig.push_back(col[v]);
+		for (const auto& pr : nbrs)
+		{
+			sig.push_back(pr.first);
+			sig.push_back(pr.second);
+		}
+	}
+
+	std::vector<uint32_t> order(nv);
+	for (size_t v = 0; v < nv; v++) order[v] = v;
+	std::sort(order.begin(), order.end(),
+		[&](uint32_t a, uint32_t b) { return sigs[a] < sigs[b]; });
+
+	uint32_t ncol = 0;
+	uint32_t oldcol = 0;
+	for (size_t i = 0; i < nv; i++)
+	{
+		if (0 < i and sigs[order[i-1]] != sigs[order[i]]) ncol++;
+		if (0 < i and col[order[i-1]] != col[order[i]]) oldcol++;
+		col[order[i]] = ncol;
+	}
+	return ncol != oldcol;
+}
+
+/// Colour refinement, until the colouring is stable.
+void Canonical::refine(Coloring& col) const
+{
+	std::vector<std::vector<uint32_t>> sigs(col.size());
+	while (rerank(col, sigs)) {}
+}
+
+/// Encode the graph, with the vertexes numbered by a discrete
+/// colouring. The vertex label and the sorted edge list of each
+/// vertex are written out, in order of the vertex numbers.
+std::vector<uint32_t> Canonical::encode(const Coloring& col) const
+{
+	size_t nv = col.size();
+	std::vector<uint32_t> vert(nv);
+	for (size_t v = 0; v < nv; v++) vert[col[v]] = v;
+
+	std::vector<uint32_t> code;
+	for (size_t i = 0; i < nv; i++)
+	{
+		uint32_t v = vert[i];
+		std::vector<std::pair<uint32_t, uint32_t>> nbrs;
+		for (const auto& pr : _adj[v])
+			nbrs.push_back({pr.first, col[pr.second]});
+		std::sort(nbrs.begin(), nbrs.end());
+
+		code.push_back(_vlabel[v]);
+		code.push_back(nbrs.size());
+		for (const auto& pr : nbrs)
+		{
+			code.push_back(pr.first);
+			code.push_back(pr.second);
+		}
+	}
+	return code;
+}
+
+/// Return true if swapping the vertexes `u` and `v` is a symmetry
+/// of the graph: that is, if they have the same label, and the same
+/// neighbors (other than each other), over the same edge labels.
+bool Canonical::twins(uint32_t u, uint32_t v) const
+{
+	if (_vlabel[u] != _vlabel[v]) return false;
+	if (_adj[u].size() != _adj[v].size()) return false;
+
+	auto nbrs = [&](uint32_t w) {
+		std::vector<std::pair<uint32_t, uint32_t>> nb(_adj[w]);
+		for (auto& pr : nb)
+			if (pr.second == u or pr.second == v) pr.second = UINT32_MAX;
+		std::sort(nb.begin(), nb.end());
+		return nb;
+	};
+	return nbrs(u) == nbrs(v);
+}
+
+/// Individualization-refinement. If the colouring is not discrete,
+/// then try giving each vertex of the first non-trivial colour class
+/// a colour of its own, refine, and recurse. Keep the smallest of
+/// the encodings found at the leaves. A vertex that is a twin of one
+/// already tried leads to the very same encodings, and is skipped;
+/// this matters for graphs with many interchangeable vertexes, such
+/// as the open sections of a partial network.
+void Canonical::search(Coloring& col)
+{
+	size_t nv = col.size();
+	std::vector<uint32_t> csize(nv, 0);
+	for (size_t v = 0; v < nv; v++) csize[col[v]]++;
+
+	uint32_t cell = 0;
+	while (cell < nv and csize[cell] < 2) cell++;
+
+	if (nv <= cell)
+	{
+		std::vector<uint32_t> code(encode(col));
+		if (0 == _leaves or code < _best) _best.swap(code);
+		_leaves++;
+		return;
+	}
+
+	std::vector<uint32_t> tried;
+	for (size_t v = 0; v < nv; v++)
+	{
+		if (col[v] != cell) continue;
+		if (0 < _leaves and MAX_LEAVES <= _leaves) return;
+
+		bool twin = false;
+		for (uint32_t u : tried)
+			if (twins(u, v)) { twin = true; break; }
+		if (twin) continue;
+		tried.push_back(v);
+
+		// Vertex v keeps the colour; the rest of its class
+		// gets the next one up, and everything above shifts up.
+		Coloring indiv(col);
+		for (size_t u = 0; u < nv; u++)
+			if (cell < indiv[u] or (cell == indiv[u] and u != v))
+				indiv[u]++;
+
+		refine(indiv);
+		search(indiv);
+	}
+}
+
+static void put(std::string& str, uint32_t n)
+{
+	for (int i = 0; i < 4; i++)
+		str.push_back((char) ((n >> (8*i)) & 0xff));
+}
+
+static void put(std::string& str, const std::string& s)
+{
+	put(str, s.size());
+	str.append(s);
+}
+
+std::string Canonical::form(void)
+{
+	Coloring col(_vlabel);
+	refine(col);
+	_leaves = 0;
+	search(col);
+
+	// The labels were replaced by their ranks; the tables of the
+	// labels make the form complete.
+	std::string str;
+	put(str, _vlabels.size());
+	for (const std::string& s : _vlabels) put(str, s);
+	put(str, _elabels.size());
+	for (const std::string& s : _elabels) put(str, s);
+	for (uint32_t n : _best) put(str, n);
+	return str;
+}
+
+// ========================== END OF FILE ==========================
@@ -0,0 +1,101 @@
+/*
+ * opencog/generate/Canonical.h
+ *
+ * Copyright (C) 2020 Linas Vepstas <linasvepstas@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_CANONICAL_H
+#define _OPENCOG_CANONICAL_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <opencog/atomspace/AtomSpace.h>
+
+namespace opencog
+{
+/** \addtogroup grp_generate
+ *  @{
+ */
+
+/// Canonical labelling of networks. A network (a linkage; a set of
+/// fully-connected sections) is viewed as a graph: the vertexes are
+/// the points, labelled by the point they are an instance of (that
+/// is, with the unique `@uuid` suffix removed), and the edges are
+/// labelled by their link type. Two networks get the same canonical
+/// form if and only if these graphs are isomorphic.
+///
+/// The canonical form is found by colour refinement, followed by a
+/// search over the ways of breaking the remaining ties, keeping the
+/// smallest encoding. For highly symmetric networks, this search can
+/// blow up; it is cut short after `MAX_LEAVES` encodings. The form is
+/// then still a complete description of the network, and so is never
+/// shared by networks that are not isomorphic; but isomorphic networks
+/// might then (rarely) get different forms.
+class Canonical
+{
+	static const size_t MAX_LEAVES = 512;
+
+	typedef std::vector<uint32_t> Coloring;
+
+	/// The graph, with labels replaced by their rank in `_vlabels`
+	/// and `_elabels`. The adjacency lists hold (edge label, vertex)
+	/// pairs, one for each connector of the vertex.
+	std::vector<std::string> _vlabels;
+	std::vector<std::string> _elabels;
+	std::vector<uint32_t> _vlabel;
+	std::vector<std::vector<std::pair<uint32_t, uint32_t>>> _adj;
+
+	std::vector<uint32_t> _best;
+	size_t _leaves;
+
+	void refine(Coloring&) const;
+	bool rerank(Coloring&, std::vector<std::vector<uint32_t>>&) const;
+	void search(Coloring&);
+	bool twins(uint32_t, uint32_t) const;
+	std::vector<uint32_t> encode(const Coloring&) const;
+
+public:
+	/// If `open` is set, the sections are taken to be the open
+	/// sections of a partial network: the vertex labels then include
+	/// the unconnected connectors, in order, and links to points that
+	/// are not in the set (that is, to closed points) are left out.
+	Canonical(const HandleSet&, bool open = false);
+
+	/// The canonical form, as a string of bytes.
+	std::string form(void);
+
+	/// Convenience wrappers.
+	static std::string form(const HandleSet& linkage) {
+		return Canonical(linkage).form();
+	}
+	static std::string open_form(const HandleSet& open_sections) {
+		return Canonical(open_sections, true).form();
+	}
+
+	/// Return the point that the unique point is an instance of.
+	/// That is, return the name with the `@uuid` suffix removed.
+	static std::string base_name(const std::string&);
+};
+
+
+/** @}*/
+}  // namespace opencog
+
+#endif // _OPENCOG_CANONICAL_H
@@ -21,11 +21,14 @@
 
 #include <opencog/atoms/base/Link.h>
 
+#include "Canonical.h"
 #include "CollectStyle.h"
+#include "Trace.h"
 
 using namespace opencog;
 
-CollectStyle::CollectStyle(void)
+CollectStyle::CollectStyle(void) :
+	_isomorphic(false)
 {
 }
 
@@ -34,25 +37,30 @@ CollectStyle::~CollectStyle() {}
 /// In this "style" of recording a result, we just tack it onto
 /// a C++ container holding the solutions. Other "styles" are
 /// possible; we could report them elsewehre, too...
+///
+/// If `_isomorphic` is set, then a solution is kept only if it has
+/// a shape not seen before; a "shape" being the network, up to the
+/// renaming of the unique points.
 void CollectStyle::record_solution(const OdoFrame& frm)
 {
+	if (_isomorphic and
+	    not _shapes.insert(Canonical::form(frm._linkage)).second)
+	{
+		GEN_TRACE(REDISCOVERY, 0, _solutions.size(), frm._linkage.size());
+		return;
+	}
+
 	size_t nsolns = _solutions.size();
 	_solutions.insert(frm._linkage);
 	size_t news = _solutions.size();
-	logger().fine("====================================");
 	if (nsolns != news)
 	{
-		logger().fine("Obtained new solution %lu of size %lu:",
-		       news, frm._linkage.size());
-		for (const Handle& lkg : frm._linkage)
-			frm.print_section(lkg);
+		GEN_TRACE(SOLUTION, 0, news, frm._linkage.size());
+		GEN_TRACE_DO(for (const Handle& lkg : frm._linkage)
+			frm.print_section(lkg));
 	}
 	else
-	{
-		logger().fine("Rediscovered solution, still have %lu size=%lu",
-		        news, frm._linkage.size());
-	}
-	logger().fine("====================================");
+		GEN_TRACE(REDISCOVERY, 0, news, frm._linkage.size());
 }
 
 /// XXX FIXME ... maybe should attach to a MemberLink or something?
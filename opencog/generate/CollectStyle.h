@@ -22,6 +22,9 @@
 #ifndef _OPENCOG_COLLECT_STYLE_H
 #define _OPENCOG_COLLECT_STYLE_H
 
+#include <string>
+#include <unordered_set>
+
 #include <opencog/generate/Odometer.h>
 
 namespace opencog
@@ -39,11 +42,17 @@ protected:
 	/// Accumulated set of fully-grounded solutions.
 	std::set<HandleSet> _solutions;
 
+	/// If set, then solutions that are isomorphic to one already
+	/// found are discarded. They are recognized by their canonical
+	/// form (see `Canonical`); the forms seen so far are kept here.
+	bool _isomorphic;
+	std::unordered_set<std::string> _shapes;
+
 public:
 	CollectStyle(void);
 	~CollectStyle();
 
-	void clear(void) { _solutions.clear(); }
+	void clear(void) { _solutions.clear(); _shapes.clear(); }
 	void record_solution(const OdoFrame&);
 
 	size_t num_solutions(void) { return _solutions.size(); }
@@ -0,0 +1,922 @@
+/*
+ * opencog/generate/CompactAggregate.cc
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+
+#include <opencog/util/Logger.h>
+#include <opencog/atoms/base/Link.h>
+
+#include "CompactAggregate.h"
+#include "Trace.h"
+
+using namespace opencog;
+
+const CompactAggregate::Id CompactAggregate::NONE;
+
+CompactAggregate::CompactAggregate(AtomSpace* as, const CompactLexis& lex)
+	: _as(as), _lex(lex)
+{
+	_cb = nullptr;
+	_parms = nullptr;
+	_steps_taken = 0;
+	_next_serial = 0;
+	_redundant = false;
+
+	std::random_device seed;
+	_rangen.seed(seed());
+}
+
+CompactAggregate::~CompactAggregate()
+{
+}
+
+void CompactAggregate::clear(void)
+{
+	while (not _frame_stack.empty()) _frame_stack.pop();
+	while (not _opensel_stack.empty()) _opensel_stack.pop();
+	while (not _odo_stack.empty()) _odo_stack.pop();
+	_trail.clear();
+
+	_pieces.clear();
+	_links.clear();
+	_edges.clear();
+	_open.clear();
+	_closed.clear();
+	_nodo = -1;
+	_wheel = -1;
+
+	_opensel._openit.clear();
+	_opensel._opensect.clear();
+	_odo = Odo();
+
+	_root_sections.clear();
+	_root_iters.clear();
+	_root_dist.clear();
+	_lexdist.clear();
+	_have_lexdist.clear();
+
+	_upoints.clear();
+	_next_serial = 0;
+	_steps_taken = 0;
+	_deadline.start(*_cb);
+	_stats.start();
+
+	// The callback is seeded with the same seed; mix in a tag, so
+	// that our draws differ from its draws.
+	if (_cb->random_seed)
+	{
+		std::seed_seq seq({_cb->random_seed, 1UL});
+		_rangen.seed(seq);
+	}
+
+	_scratch = createAtomSpace(_as);
+	_cb->clear(_scratch.get());
+	LinkStyle::clear();
+	LinkStyle::_point_set = _cb->point_set;
+	LinkStyle::_scratch = _scratch.get();
+}
+
+void CompactAggregate::aggregate(const HandleSet& nuclei,
+                                 GenerateCallback& cb)
+{
+	_parms = nullptr;
+	run(nuclei, cb);
+}
+
+void CompactAggregate::aggregate(const HandleSet& nuclei,
+                                 GenerateCallback& cb,
+                                 RandomParameters& parms)
+{
+	_parms = &parms;
+	run(nuclei, cb);
+}
+
+/// Same as `Aggregate::aggregate()`, together with the `root_set()`
+/// of the callbacks.
+void CompactAggregate::run(const HandleSet& nuclei, GenerateCallback& cb)
+{
+	_cb = &cb;
+	clear();
+
+	for (const Handle& point : nuclei)
+	{
+		std::vector<Id> sects;
+		Id pid = _lex.point_id(point);
+		if (NONE != pid)
+			for (Id sect : _lex.entries(pid)) sects.push_back(sect);
+
+		if (_parms)
+		{
+			if (0 == sects.size())
+				throw RuntimeException(TRACE_INFO,
+					"No dictionary entry for root=%s",
+					point->to_string().c_str());
+
+			std::vector<double> pdf;
+			for (Id sect : sects) pdf.push_back(_lex.weight(sect));
+			_root_dist.emplace_back(pdf.begin(), pdf.end());
+		}
+		_root_sections.emplace_back(std::move(sects));
+		_root_iters.push_back(0);
+	}
+
+	if (_parms)
+	{
+		_lexdist.resize(_lex.num_connectors());
+		_have_lexdist.resize(_lex.num_connectors(), false);
+	}
+
+	std::vector<Id> starters;
+	while (next_root(starters))
+	{
+		push_frame();
+		for (Id sect : starters)
+		{
+			Id pc = add_piece(sect);
+			_open.insert(pc);
+			_trail.push_back({OPEN_INSERT, pc, 0});
+		}
+		recurse();
+		pop_frame();
+	}
+
+	_stats.scratch_atoms = _scratch->get_size();
+	_stats.stop();
+	_stats.print();
+}
+
+/// Same as `SimpleCallback::next_root()`, or, for random draws,
+/// `RandomCallback::next_root()`.
+bool CompactAggregate::next_root(std::vector<Id>& starters)
+{
+	size_t len = _root_sections.size();
+	if (len == 0) return false;
+
+	// Stop iterating if limits have been reached.
+	if (_deadline.expired()) return false;
+	if (_cb->max_steps < _steps_taken) return false;
+	if (_cb->max_solutions <= _cb->num_solutions()) return false;
+
+	starters.clear();
+	if (_parms)
+	{
+		for (size_t i=0; i<len; i++)
+			starters.push_back(_root_sections[i][_root_dist[i](_rangen)]);
+		return true;
+	}
+
+	for (size_t i=0; i<len; i++)
+	{
+		if (0 == _root_sections[i].size()) return false;
+
+		size_t iter = _root_iters[i];
+		if (_root_sections[i].size() == iter)
+		{
+			if (len-1 == i) return false;
+			iter = 0;
+			_root_iters[i] = iter;
+			_root_iters[i+1] ++;
+		}
+		else if (0 == i)
+		{
+			_root_iters[0]++;
+		}
+		starters.push_back(_root_sections[i][iter]);
+	}
+	return true;
+}
+
+/// Place a new piece, with all connectors open.
+CompactAggregate::Id CompactAggregate::add_piece(Id sect)
+{
+	Id arity = _lex.disjunct(sect).size();
+	Id pc = _pieces.size();
+	_pieces.push_back({sect, (Id) _links.size(), arity, _next_serial++,
+	                   Handle::UNDEFINED});
+	_links.resize(_links.size() + arity, NONE);
+	return pc;
+}
+
+// ---------------------------------------------------------------
+
+/// Same as `Aggregate::recurse()`
+void CompactAggregate::recurse(void)
+{
+	// Nothing to do.
+	if (0 == _open.size()) return;
+
+	// Halt recursion, if need be.
+	if (not step()) return;
+
+	// Initialize a brand-new odometer at the next recursion level.
+	push_odo();
+	bool more = init_odometer();
+	if (not more)
+	{
+		pop_odo();
+		return;
+	}
+
+	// Take the first step.
+	_odo._step = 0;
+	more = do_step();
+	_odo._step = _odo._size-1;
+
+	while (true)
+	{
+		// Odometer is exhausted; we are done.
+		if (not more)
+		{
+			pop_odo();
+			return;
+		}
+
+		if (not _redundant) recurse();
+
+		// Exploration is done, step to the next state.
+		more = step_odometer();
+	}
+}
+
+/// Same as the `step()` of the callbacks.
+bool CompactAggregate::step(void)
+{
+	_steps_taken ++;
+	if (_deadline.expired()) return false;
+	if (_cb->max_steps < _steps_taken) return false;
+	if (_cb->max_solutions <= _cb->num_solutions()) return false;
+	if (_cb->max_network_size < _closed.size()) return false;
+	if (_cb->max_depth < _nodo) return false;
+	return true;
+}
+
+/// Same as `Aggregate::init_odometer()`
+bool CompactAggregate::init_odometer(void)
+{
+	_odo._piece.clear();
+	_odo._from_index.clear();
+	_odo._to_con.clear();
+	_odo._picks.clear();
+	_odo._con_runs.clear();
+	_odo._sect_runs.clear();
+	_odo._explored.clear();
+	_odo._twinned = false;
+
+	for (Id pc : _open)
+	{
+		const Piece& piece = _pieces[pc];
+		CompactLexis::Range disj = _lex.disjunct(piece._sect);
+		for (Id idx = 0; idx < disj.size(); idx++)
+		{
+			// Unconnected connectors only.
+			if (NONE != _links[piece._base + idx]) continue;
+
+			// If none, then this connector can never be closed.
+			CompactLexis::Range to_cons = _lex.joints(disj[idx]);
+			if (0 == to_cons.size()) return false;
+
+			for (Id to_con : to_cons)
+			{
+				_odo._piece.push_back(pc);
+				_odo._from_index.push_back(idx);
+				_odo._to_con.push_back(to_con);
+			}
+		}
+	}
+
+	_odo._size = _odo._to_con.size();
+	if (0 == _odo._size) return false;
+	_odo._step = 0;
+	_stats.odometer(_odo_stack.size(), _odo._size);
+
+	if (_cb->break_symmetry)
+	{
+		_odo._picks.resize(_odo._size, {Odometer::SKIPPED, NONE});
+		_odo._npieces = _pieces.size();
+		find_twins();
+	}
+	return true;
+}
+
+/// Same as `Aggregate::do_step()`
+bool CompactAggregate::do_step(void)
+{
+	_redundant = false;
+
+	// Erase the last connection that was made.
+	if (_wheel == _odo._step and _nodo == _odo_stack.size()) pop_frame();
+
+	bool did_step = false;
+	for (size_t ic = _odo._step; ic < _odo._size; ic++)
+	{
+		Id fm = _odo._piece[ic];
+		Id offset = _odo._from_index[ic];
+		Id to_con = _odo._to_con[ic];
+
+		// Is there an open connector at this location?
+		if (NONE != _links[_pieces[fm]._base + offset])
+		{
+			if (_cb->break_symmetry)
+				_odo._picks[ic] = {Odometer::SKIPPED, NONE};
+			if (ic == _odo._step)
+			{
+				// This wheel has "effectively" rolled over.
+				_odo._step = ic - 1;
+				return false;
+			}
+			continue;
+		}
+
+		Pick pick = _parms ? random_select(fm, to_con) : select(ic, fm, to_con);
+		_stats.selects ++;
+		if (NONE == pick._piece and NONE == pick._sect)
+		{
+			_stats.null_selects ++;
+			// This wheel has rolled over.
+			_odo._step = ic - 1;
+			return false;
+		}
+
+		did_step = true;
+		if (_cb->break_symmetry)
+			_odo._picks[ic] = (NONE != pick._piece) ?
+				std::make_pair((Id) Odometer::OPENED, pick._piece) :
+				std::make_pair((Id) Odometer::DRAWN, pick._sect);
+		push_frame();
+		_wheel = ic;
+
+		// A new piece is placed only now, after the push, so that
+		// the pop takes it away.
+		Id to = pick._piece;
+		if (NONE == to) to = add_piece(pick._sect);
+		connect(fm, offset, to, to_con);
+	}
+
+	if (not did_step)
+	{
+		if (0 < _odo._step) _odo._step --;
+		return false;
+	}
+
+	// Next time, we will turn just the last wheel.
+	_odo._step = _odo._size - 1;
+
+	// Symmetric to a state that was already explored; skip it.
+	if (_odo._twinned and redundant())
+	{
+		_redundant = true;
+		return true;
+	}
+
+	// If we found a solution, record it.
+	if (0 == _open.size()) solution();
+
+	return true;
+}
+
+/// Same as `Aggregate::step_odometer()`
+bool CompactAggregate::step_odometer(void)
+{
+	if (not step()) return false;
+
+	// Total rollover
+	if (_odo._size < _odo._step)
+	{
+		_stats.rollovers ++;
+		return false;
+	}
+
+	// Take a step.
+	bool did_step = do_step();
+	while (not did_step)
+	{
+		// If the stepper rolled over to minus-one, then we're done.
+		if (SIZE_MAX == _odo._step)
+		{
+			_stats.rollovers ++;
+			return false;
+		}
+		did_step = do_step();
+	}
+
+	return did_step;
+}
+
+/// Connect connector `offset` on piece `fm` to the first open
+/// `to_con` on piece `to`. If these are one and the same connector,
+/// then it is connected to itself.
+void CompactAggregate::connect(Id fm, Id offset, Id to, Id to_con)
+{
+	const Piece& tp = _pieces[to];
+	CompactLexis::Range tdisj = _lex.disjunct(tp._sect);
+	Id tidx = NONE;
+	for (Id i = 0; i < tdisj.size(); i++)
+	{
+		if (to_con == tdisj[i] and NONE == _links[tp._base + i])
+		{
+			tidx = i;
+			break;
+		}
+	}
+
+	Id fm_con = _lex.disjunct(_pieces[fm]._sect)[offset];
+	Id edge = _edges.size();
+	_edges.push_back({fm_con, fm, to});
+
+	link(fm, offset, edge);
+	if (fm != to or tidx != offset) link(to, tidx, edge);
+}
+
+/// Attach `edge` to connector `index` of piece `pc`, and move the
+/// piece to the linkage, if that was its last open connector.
+void CompactAggregate::link(Id pc, Id index, Id edge)
+{
+	Piece& piece = _pieces[pc];
+	_links[piece._base + index] = edge;
+	piece._nopen --;
+	_trail.push_back({LINK, pc, index});
+
+	if (0 < piece._nopen)
+	{
+		if (_open.insert(pc).second)
+			_trail.push_back({OPEN_INSERT, pc, 0});
+		return;
+	}
+
+	if (0 < _open.erase(pc))
+		_trail.push_back({OPEN_ERASE, pc, 0});
+	_closed.insert(pc);
+	_trail.push_back({CLOSE, pc, 0});
+}
+
+void CompactAggregate::undo(const Change& chg)
+{
+	switch (chg._op)
+	{
+		case OPEN_INSERT: _open.erase(chg._piece); break;
+		case OPEN_ERASE: _open.insert(chg._piece); break;
+		case CLOSE: _closed.erase(chg._piece); break;
+		case LINK:
+		{
+			Piece& piece = _pieces[chg._piece];
+			_links[piece._base + chg._index] = NONE;
+			piece._nopen ++;
+			piece._atom = Handle::UNDEFINED;
+			break;
+		}
+	}
+}
+
+void CompactAggregate::push_frame(void)
+{
+	_opensel_stack.push(std::move(_opensel));
+	_opensel._openit.clear();
+	_opensel._opensect.clear();
+
+	_stats.frame_pushes ++;
+	_frame_stack.push({_trail.size(), _pieces.size(), _edges.size(),
+	                   _nodo, _wheel});
+	_nodo = _odo_stack.size();
+	_wheel = -1;
+}
+
+void CompactAggregate::pop_frame(void)
+{
+	_opensel = std::move(_opensel_stack.top()); _opensel_stack.pop();
+
+	const FrameMark& mark = _frame_stack.top();
+	while (mark._trail < _trail.size())
+	{
+		undo(_trail.back());
+		_trail.pop_back();
+	}
+	if (mark._npieces < _pieces.size())
+	{
+		_links.resize(_pieces[mark._npieces]._base);
+		_pieces.resize(mark._npieces);
+	}
+	_edges.resize(mark._nedges);
+
+	_nodo = mark._nodo;
+	_wheel = mark._wheel;
+	_frame_stack.pop();
+}
+
+void CompactAggregate::push_odo(void)
+{
+	_stats.odo_pushes ++;
+	_odo_stack.push(std::move(_odo));
+	_odo._lexlit.clear();
+	_odo._frame_depth = _frame_stack.size();
+}
+
+void CompactAggregate::pop_odo(void)
+{
+	// Realign the frame stack to where we started.
+	while (_odo._frame_depth < _frame_stack.size()) pop_frame();
+
+	_stats.odo_pops ++;
+	_odo = std::move(_odo_stack.top()); _odo_stack.pop();
+}
+
+// ---------------------------------------------------------------
+// Symmetry breaking. This is the same as in `Aggregate`; see there
+// for an explanation.
+
+/// Same as `Aggregate::find_twins()`
+void CompactAggregate::find_twins(void)
+{
+	std::map<std::vector<Id>, size_t> twins;
+
+	size_t ic = 0;
+	while (ic < _odo._size)
+	{
+		Id pc = _odo._piece[ic];
+		const Piece& piece = _pieces[pc];
+		CompactLexis::Range disj = _lex.disjunct(piece._sect);
+
+		std::map<Id, size_t> cons;
+		size_t first = _odo._con_runs.size();
+		while (ic < _odo._size and _odo._piece[ic] == pc)
+		{
+			size_t begin = ic;
+			Id idx = _odo._from_index[ic];
+			while (ic < _odo._size and _odo._piece[ic] == pc and
+			       _odo._from_index[ic] == idx) ic++;
+
+			auto cit = cons.emplace(disj[idx], _odo._con_runs.size());
+			_odo._con_runs.push_back({begin, ic, cit.first->second});
+			if (not cit.second) _odo._twinned = true;
+		}
+
+		// The point, and, for each connector, either the connector,
+		// or the link type and the piece at the far end. Connector
+		// IDs and link type IDs are kept apart by the marker.
+		std::vector<Id> key;
+		key.push_back(_lex.section_point(piece._sect));
+		for (Id idx = 0; idx < disj.size(); idx++)
+		{
+			Id edge = _links[piece._base + idx];
+			if (NONE == edge)
+			{
+				key.push_back(disj[idx]);
+				continue;
+			}
+			const Edge& edg = _edges[edge];
+			key.push_back(NONE);
+			key.push_back(_lex.con_type(edg._con));
+			key.push_back((edg._fm == pc) ? edg._to : edg._fm);
+		}
+
+		auto sit = twins.emplace(key, _odo._sect_runs.size());
+		_odo._sect_runs.push_back({first, _odo._con_runs.size(),
+		                           sit.first->second});
+		if (not sit.second) _odo._twinned = true;
+	}
+}
+
+/// Same as `sort_runs()` in `Aggregate`.
+static void sort_runs(const std::vector<Odometer::Run>& runs,
+                      std::vector<std::vector<CompactLexis::Id>>& keys,
+                      const std::vector<bool>& drawn)
+{
+	std::map<size_t, std::vector<size_t>> classes;
+	for (size_t ir = 0; ir < runs.size(); ir++)
+		if (drawn[ir]) classes[runs[ir]._class].push_back(ir);
+
+	for (const auto& cls : classes)
+	{
+		if (cls.second.size() < 2) continue;
+		std::vector<std::vector<CompactLexis::Id>> sorted;
+		for (size_t ir : cls.second) sorted.push_back(keys[ir]);
+		std::sort(sorted.begin(), sorted.end());
+		for (size_t i = 0; i < sorted.size(); i++)
+			keys[cls.second[i]] = sorted[i];
+	}
+}
+
+/// Same as `Aggregate::redundant()`
+bool CompactAggregate::redundant(void)
+{
+	size_t ncr = _odo._con_runs.size();
+	std::vector<std::vector<Id>> ckeys(ncr);
+	std::vector<bool> cdrawn(ncr);
+	for (size_t ir = 0; ir < ncr; ir++)
+	{
+		const Odometer::Run& run = _odo._con_runs[ir];
+		std::vector<Id>& key = ckeys[ir];
+		bool drawn = false;
+		bool fixed = false;
+		for (size_t ic = run._begin; ic < run._end; ic++)
+		{
+			const auto& pick = _odo._picks[ic];
+			key.push_back(pick.first);
+			if (Odometer::SKIPPED == pick.first) continue;
+			if (Odometer::OPENED == pick.first)
+			{
+				// Attached to a piece placed in this very step.
+				if (_odo._npieces <= pick.second) return false;
+				fixed = true;
+			}
+			else drawn = true;
+			key.push_back(pick.second);
+		}
+		cdrawn[ir] = drawn and not fixed;
+	}
+	sort_runs(_odo._con_runs, ckeys, cdrawn);
+
+	size_t nsr = _odo._sect_runs.size();
+	std::vector<std::vector<Id>> skeys(nsr);
+	std::vector<bool> sdrawn(nsr, true);
+	for (size_t ir = 0; ir < nsr; ir++)
+	{
+		const Odometer::Run& run = _odo._sect_runs[ir];
+		for (size_t icr = run._begin; icr < run._end; icr++)
+		{
+			skeys[ir].insert(skeys[ir].end(),
+				ckeys[icr].begin(), ckeys[icr].end());
+			skeys[ir].push_back(NONE);
+			if (not cdrawn[icr]) sdrawn[ir] = false;
+		}
+	}
+	sort_runs(_odo._sect_runs, skeys, sdrawn);
+
+	std::vector<Id> key;
+	for (const auto& sk : skeys)
+	{
+		key.insert(key.end(), sk.begin(), sk.end());
+		key.push_back(NONE - 1);
+	}
+	return not _odo._explored.insert(key).second;
+}
+
+// ---------------------------------------------------------------
+// Exhaustive selection. This is the same as `SimpleCallback::select()`
+// and friends; see those for comments.
+
+CompactAggregate::Pick CompactAggregate::select(size_t ic, Id fm,
+                                                 Id to_con)
+{
+	Pick pick = select_from_open(fm, to_con);
+	if (NONE != pick._piece) return pick;
+
+	// If this is non-empty, the the odometer rolled over.
+	if (_opensel._opensect.end() != _opensel._opensect.find(to_con))
+		return {NONE, NONE};
+
+	return select_from_lexis(ic, to_con);
+}
+
+CompactAggregate::Pick CompactAggregate::select_from_open(Id fm, Id to_con)
+{
+	auto oit = _opensel._openit.find(to_con);
+	unsigned fit = (_opensel._openit.end() == oit) ? 0 : oit->second;
+	if (0 < fit)
+		return check_self(_opensel._opensect[to_con], fm, to_con, fit);
+
+	std::vector<Id> to_pieces;
+	find_open(to_pieces, fm, to_con, true);
+	if (0 == to_pieces.size()) return {NONE, NONE};
+
+	_opensel._openit[to_con] = 0;
+	return check_self(to_pieces, fm, to_con, 0);
+}
+
+CompactAggregate::Pick CompactAggregate::check_self(
+                               const std::vector<Id>& to_pieces,
+                               Id fm, Id to_con, size_t fit)
+{
+	if (to_pieces.size() <= fit) return {NONE, NONE};
+
+	_opensel._openit[to_con] ++;
+	if (_cb->allow_self_connections) return {to_pieces[fit], NONE};
+
+	while (true)
+	{
+		if (to_pieces[fit] != fm) return {to_pieces[fit], NONE};
+		fit ++;
+		_opensel._openit[to_con] = fit;
+		if (to_pieces.size() <= fit) return {NONE, NONE};
+	}
+}
+
+CompactAggregate::Pick CompactAggregate::select_from_lexis(size_t ic,
+                                                            Id to_con)
+{
+	CompactLexis::Range to_sects = _lex.connectables(to_con);
+
+	auto lit = _odo._lexlit.find(ic);
+	unsigned curit = (_odo._lexlit.end() == lit) ? 0 : lit->second;
+	if (0 == curit)
+	{
+		if (0 == to_sects.size()) return {NONE, NONE};
+		_odo._lexlit[ic] = 1;
+		return {NONE, to_sects[0]};
+	}
+
+	if (to_sects.size() <= curit)
+	{
+		_odo._lexlit.erase(lit);
+		return {NONE, NONE};
+	}
+
+	lit->second ++;
+	return {NONE, to_sects[curit]};
+}
+
+// ---------------------------------------------------------------
+// Random selection. This is the same as `RandomCallback::select()`
+// and friends; see those for comments. The parameters are not given
+// a frame to look at; the `BasicParameters` do not need one.
+
+CompactAggregate::Pick CompactAggregate::random_select(Id fm, Id to_con)
+{
+	if (_parms->connect_existing(_empty_frame))
+	{
+		Pick pick = random_from_open(fm, to_con);
+		if (NONE != pick._piece) return pick;
+	}
+	return random_from_lexis(to_con);
+}
+
+CompactAggregate::Pick CompactAggregate::random_from_open(Id fm, Id to_con)
+{
+	auto tosit = _opensel._opensect.find(to_con);
+	if (_opensel._opensect.end() == tosit)
+	{
+		tosit = _opensel._opensect.emplace(to_con, std::vector<Id>()).first;
+		find_open(tosit->second, fm, to_con, _cb->allow_self_connections);
+	}
+
+	const std::vector<Id>& to_pieces = tosit->second;
+	if (0 == to_pieces.size()) return {NONE, NONE};
+	if (1 == to_pieces.size()) return {to_pieces[0], NONE};
+
+	std::uniform_int_distribution<size_t> dist(0, to_pieces.size()-1);
+	return {to_pieces[dist(_rangen)], NONE};
+}
+
+CompactAggregate::Pick CompactAggregate::random_from_lexis(Id to_con)
+{
+	CompactLexis::Range to_sects = _lex.connectables(to_con);
+	if (0 == to_sects.size()) return {NONE, NONE};
+
+	if (not _have_lexdist[to_con])
+	{
+		std::vector<double> pdf;
+		for (Id sect : to_sects) pdf.push_back(_lex.weight(sect));
+		_lexdist[to_con] =
+			std::discrete_distribution<size_t>(pdf.begin(), pdf.end());
+		_have_lexdist[to_con] = true;
+	}
+	return {NONE, to_sects[_lexdist[to_con](_rangen)]};
+}
+
+// ---------------------------------------------------------------
+
+/// List the open pieces having an unconnected `to_con`, once for each
+/// such connector, subject to the pairing limits.
+void CompactAggregate::find_open(std::vector<Id>& to_pieces,
+                                 Id fm, Id to_con, bool with_self)
+{
+	Id linkty = _lex.con_type(to_con);
+	for (Id pc : _open)
+	{
+		if (not with_self and pc == fm) continue;
+
+		const Piece& piece = _pieces[pc];
+		CompactLexis::Range disj = _lex.disjunct(piece._sect);
+		for (Id idx = 0; idx < disj.size(); idx++)
+		{
+			if (to_con != disj[idx]) continue;
+			if (NONE != _links[piece._base + idx]) continue;
+
+			// Wait, are these already connected?
+			if (_cb->pair_any_links <= num_any_links(fm, pc))
+				continue;
+			if (1 < _cb->pair_any_links and
+			    _cb->pair_typed_links <= num_typed_links(fm, pc, linkty))
+				continue;
+			to_pieces.push_back(pc);
+		}
+	}
+}
+
+/// Same as `LinkStyle::num_any_links()`. Note that, just as there,
+/// every link on a piece counts as connecting it to itself.
+size_t CompactAggregate::num_any_links(Id fm, Id to)
+{
+	const Piece& piece = _pieces[fm];
+	size_t arity = _lex.disjunct(piece._sect).size();
+	size_t cnt = 0;
+	for (size_t idx = 0; idx < arity; idx++)
+	{
+		Id edge = _links[piece._base + idx];
+		if (NONE == edge) continue;
+		if (fm == to or _edges[edge]._fm == to or _edges[edge]._to == to)
+			cnt++;
+	}
+	return cnt;
+}
+
+/// Same as `LinkStyle::num_undirected_links()`
+size_t CompactAggregate::num_typed_links(Id fm, Id to, Id linkty)
+{
+	const Piece& piece = _pieces[fm];
+	size_t arity = _lex.disjunct(piece._sect).size();
+	size_t cnt = 0;
+	for (size_t idx = 0; idx < arity; idx++)
+	{
+		Id edge = _links[piece._base + idx];
+		if (NONE == edge) continue;
+
+		const Edge& e = _edges[edge];
+		if (_lex.con_type(e._con) != linkty) continue;
+		if ((e._fm == fm and e._to == to) or (e._fm == to and e._to == fm))
+			cnt++;
+	}
+	return cnt;
+}
+
+// ---------------------------------------------------------------
+
+/// Return the unique point for the piece. The same piece appears
+/// under the same point in all of the solutions it is a part of.
+Handle CompactAggregate::make_point(Id pc)
+{
+	const Piece& piece = _pieces[pc];
+	auto fnd = _upoints.find(piece._serial);
+	if (_upoints.end() != fnd) return fnd->second;
+
+	Handle upoint(create_unique_point(
+		_lex.point(_lex.section_point(piece._sect))));
+	_upoints.emplace(piece._serial, upoint);
+	return upoint;
+}
+
+/// Return the section atom for the closed piece.
+const Handle& CompactAggregate::make_section(Id pc)
+{
+	Piece& piece = _pieces[pc];
+	if (piece._atom) return piece._atom;
+
+	CompactLexis::Range disj = _lex.disjunct(piece._sect);
+	HandleSeq oset;
+	for (size_t idx = 0; idx < disj.size(); idx++)
+	{
+		const Edge& e = _edges[_links[piece._base + idx]];
+		oset.push_back(create_undirected_link(
+			_lex.connector(e._con), _lex.connector(disj[idx]),
+			make_point(e._fm), make_point(e._to)));
+	}
+
+	Handle point(make_point(pc));
+	piece._atom = _scratch->add_link(SECTION, point,
+		_scratch->add_link(CONNECTOR_SEQ, std::move(oset)));
+	return piece._atom;
+}
+
+/// A solution has been found; create the atoms for it, and hand it
+/// to the callback. Pieces that were part of earlier solutions have
+/// their atoms already.
+void CompactAggregate::solution(void)
+{
+	OdoFrame frm;
+	frm.clear();
+	for (Id pc : _closed)
+		frm._linkage.insert(make_section(pc));
+
+	GEN_TRACE(SOLUTION, _odo_stack.size(), _cb->num_solutions(),
+		frm._linkage.size());
+	size_t before = _cb->num_solutions();
+	_cb->solution(frm);
+	size_t after = _cb->num_solutions();
+	_stats.solution((before != after) or (0 == after));
+}
+
+Handle CompactAggregate::get_solutions(void)
+{
+	Handle results = _cb->get_solutions();
+
+	// Populate the atomspace, only if there are results to report.
+	if (0 < results->get_arity()) LinkStyle::save_work(_as);
+	return results;
+}
+
+// ========================== END OF FILE ==========================
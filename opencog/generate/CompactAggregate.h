@@ -0,0 +1,254 @@
+/*
+ * opencog/generate/CompactAggregate.h
+ *
+ * Copyright (C) 2020 Linas Vepstas <linasvepstas@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_COMPACT_AGGREGATE_H
+#define _OPENCOG_COMPACT_AGGREGATE_H
+
+#include <map>
+#include <random>
+#include <set>
+#include <stack>
+#include <vector>
+
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/generate/AggregateStats.h>
+#include <opencog/generate/CompactLexis.h>
+#include <opencog/generate/Deadline.h>
+#include <opencog/generate/GenerateCallback.h>
+#include <opencog/generate/LinkStyle.h>
+#include <opencog/generate/RandomParameters.h>
+
+namespace opencog
+{
+/** \addtogroup grp_generate
+ *  @{
+ */
+
+/// Aggregation on integer IDs. This runs the same breadth-first
+/// odometer algorithm as `Aggregate` (see the README.md) but on the
+/// tables of a `CompactLexis`: the partial assembly is held in flat
+/// arrays of small integers, instead of in atoms. Atoms are created
+/// only for the solutions, once they are found.
+///
+/// The selection policies are built in, rather than being delegated
+/// to a callback; they are the same as those of the `SimpleCallback`
+/// (exhaustive enumeration) and of the `RandomCallback` (random
+/// draws, when `RandomParameters` are given). The callback that is
+/// passed in supplies the generic parameters (the limits, the
+/// self-connection and pairing rules) and collects the solutions.
+/// None of its other methods are called.
+class CompactAggregate : private LinkStyle
+{
+	typedef CompactLexis::Id Id;
+	static const Id NONE = CompactLexis::NONE;
+
+private:
+	AtomSpace* _as;
+	AtomSpacePtr _scratch;
+	const CompactLexis& _lex;
+
+	/// Limits, and the solution collector.
+	GenerateCallback* _cb;
+	Deadline _deadline;
+	AggregateStats _stats;
+
+	/// Random draws, if set; else exhaustive enumeration.
+	RandomParameters* _parms;
+	std::mt19937 _rangen;
+
+	size_t _steps_taken;
+
+	// -------------------------------------------
+	/// A piece is a placed instance of a section. Its connectors
+	/// are the run of `_links` starting at `_base`; each holds the
+	/// edge attached there, or NONE, if it is still open. The
+	/// serial number is unique over the entire run, and identifies
+	/// the piece in the solutions. Once the piece is closed, the
+	/// section atom for it is made only once, and kept here, until
+	/// the piece is opened again.
+	struct Piece
+	{
+		Id _sect;
+		Id _base;
+		Id _nopen;
+		size_t _serial;
+		Handle _atom;
+	};
+	std::vector<Piece> _pieces;
+	std::vector<Id> _links;
+	size_t _next_serial;
+
+	struct Edge
+	{
+		Id _con;   // The from-connector
+		Id _fm;    // The two pieces.
+		Id _to;
+	};
+	std::vector<Edge> _edges;
+
+	/// Current traversal state; same as `OdoFrame`.
+	std::set<Id> _open;
+	std::set<Id> _closed;
+	size_t _nodo;
+	size_t _wheel;
+
+	// -------------------------------------------
+	/// Undo trail. Pieces and edges are only ever appended, and so
+	/// are undone by truncation; the rest is recorded here.
+	enum Op { OPEN_INSERT, OPEN_ERASE, CLOSE, LINK };
+	struct Change
+	{
+		Op _op;
+		Id _piece;
+		Id _index;
+	};
+	std::vector<Change> _trail;
+
+	struct FrameMark
+	{
+		size_t _trail;
+		size_t _npieces;
+		size_t _nedges;
+		size_t _nodo;
+		size_t _wheel;
+	};
+	std::stack<FrameMark> _frame_stack;
+
+	// Selections made in the current frame. Same as the ones
+	// in the `SimpleCallback` and the `RandomCallback`.
+	struct OpenSelections
+	{
+		std::map<Id, unsigned> _openit;
+		std::map<Id, std::vector<Id>> _opensect;
+	};
+	OpenSelections _opensel;
+	std::stack<OpenSelections> _opensel_stack;
+
+	void push_frame(void);
+	void pop_frame(void);
+
+	// -------------------------------------------
+	/// Odometer, same as `Odometer`. The lexis iterators of the
+	/// `SimpleCallback` live here, since they are per-odometer;
+	/// they are keyed by wheel.
+	struct Odo
+	{
+		std::vector<Id> _piece;
+		std::vector<Id> _from_index;
+		std::vector<Id> _to_con;
+		size_t _size;
+		size_t _step;
+		size_t _frame_depth;
+		std::map<size_t, unsigned> _lexlit;
+
+		// Symmetry breaking; same as in `Odometer`. The picks are
+		// the kind of pick, and the piece or the section picked.
+		std::vector<std::pair<Id, Id>> _picks;
+		std::vector<Odometer::Run> _con_runs;
+		std::vector<Odometer::Run> _sect_runs;
+		std::set<std::vector<Id>> _explored;
+		bool _twinned;
+		size_t _npieces;
+	};
+	Odo _odo;
+	std::stack<Odo> _odo_stack;
+
+	void push_odo(void);
+	void pop_odo(void);
+
+	// -------------------------------------------
+	// Nucleation points.
+	std::vector<std::vector<Id>> _root_sections;
+	std::vector<size_t> _root_iters;
+	std::vector<std::discrete_distribution<size_t>> _root_dist;
+	bool next_root(std::vector<Id>&);
+
+	// Weighted choosers for the lexis, one per to-connector.
+	std::vector<std::discrete_distribution<size_t>> _lexdist;
+	std::vector<bool> _have_lexdist;
+
+	// -------------------------------------------
+	/// What `select()` picked: either an existing piece, or a
+	/// section, to be placed as a new piece. Both NONE if nothing.
+	struct Pick
+	{
+		Id _piece;
+		Id _sect;
+	};
+	Pick select(size_t, Id, Id);
+	Pick select_from_open(Id, Id);
+	Pick check_self(const std::vector<Id>&, Id, Id, size_t);
+	Pick select_from_lexis(size_t, Id);
+	Pick random_select(Id, Id);
+	Pick random_from_open(Id, Id);
+	Pick random_from_lexis(Id);
+	void find_open(std::vector<Id>&, Id, Id, bool);
+	size_t num_any_links(Id, Id);
+	size_t num_typed_links(Id, Id, Id);
+
+	// -------------------------------------------
+	void clear(void);
+	Id add_piece(Id);
+	void link(Id, Id, Id);
+	void connect(Id, Id, Id, Id);
+	void undo(const Change&);
+
+	bool step(void);
+	bool _redundant;
+	void find_twins(void);
+	bool redundant(void);
+	bool init_odometer(void);
+	bool step_odometer(void);
+	bool do_step(void);
+	void recurse(void);
+	void run(const HandleSet&, GenerateCallback&);
+
+	// -------------------------------------------
+	// Solutions
+	std::map<size_t, Handle> _upoints;
+	OdoFrame _empty_frame;
+	void solution(void);
+	Handle make_point(Id);
+	const Handle& make_section(Id);
+
+public:
+	CompactAggregate(AtomSpace*, const CompactLexis&);
+	~CompactAggregate();
+
+	/// Exhaustive enumeration, same as with the `SimpleCallback`.
+	void aggregate(const HandleSet&, GenerateCallback&);
+
+	/// Random draws, same as with the `RandomCallback`. The section
+	/// weights are taken from the `CompactLexis`.
+	void aggregate(const HandleSet&, GenerateCallback&, RandomParameters&);
+
+	Handle get_solutions(void);
+	size_t num_steps(void) const { return _steps_taken; }
+
+	/// Statistics of the last search; the same as those of `Aggregate`.
+	const AggregateStats& stats(void) const { return _stats; }
+};
+
+
+/** @}*/
+}  // namespace opencog
+
+#endif // _OPENCOG_COMPACT_AGGREGATE_H
@@ -0,0 +1,733 @@
+/*
+ * opencog/generate/CompactLexis.cc
+ *
+ * Copyright (C) 2020 Linas Vepstas <linasvepstas@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include <opencog/atoms/base/Link.h>
+#include <opencog/atoms/base/Node.h>
+#include <opencog/atoms/value/FloatValue.h>
+
+#include "CompactLexis.h"
+
+using namespace opencog;
+
+const CompactLexis::Id CompactLexis::NONE;
+
+// ===============================================================
+// The file format. A header, followed by the blocks, each aligned
+// to eight bytes. The blocks are the tables, as they are in memory,
+// plus the names of the nodes that the IDs stand for. Node types
+// are saved by name, as the type numbers depend on which atom types
+// are loaded. The byte order and the size of an ID are checked when
+// the file is mapped; the file is not portable between machines
+// that differ in these.
+
+namespace {
+
+const char MAGIC[8] = {'O', 'C', 'L', 'E', 'X', 'I', 'S', '\0'};
+
+// Bump this whenever the layout changes.
+const uint32_t VERSION = 2;
+const uint32_t ENDIAN_MARK = 0x01020304;
+
+enum Block
+{
+	SECTION_POINT, CON_TYPE, CON_POLE,
+	DISJUNCT_OFF, DISJUNCTS, MATE_OFF, MATES,
+	CONNECTABLE_OFF, CONNECTABLES, ENTRY_OFF, ENTRIES,
+	WEIGHTS,
+	POINT_TYPE, POINT_NAME, POINT_ORDER,
+	LINK_TYPE_TYPE, LINK_TYPE_NAME,
+	POLE_TYPE, POLE_NAME,
+	KEY_TYPE, KEY_NAME,
+	TYPE_NAME, STRINGS,
+	NUM_BLOCKS
+};
+
+struct Header
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t byte_order;
+	uint32_t id_size;
+	uint32_t num_blocks;
+	uint64_t signature;
+	uint64_t offset[NUM_BLOCKS];
+	uint64_t count[NUM_BLOCKS];
+};
+
+/// The size of one element of the block.
+size_t elt_size(int blk)
+{
+	switch (blk)
+	{
+		case WEIGHTS: return sizeof(double);
+		case POINT_NAME: case LINK_TYPE_NAME: case POLE_NAME:
+		case KEY_NAME: case TYPE_NAME: return sizeof(uint64_t);
+		case STRINGS: return 1;
+		default: return sizeof(CompactLexis::Id);
+	}
+}
+
+size_t align8(size_t off) { return (off + 7) & ~((size_t) 7); }
+
+} // namespace
+
+/// What the mapped file holds, other than the tables proper.
+struct CompactLexis::Mapped
+{
+	void* _base = nullptr;
+	size_t _length = 0;
+
+	/// A table of nodes: for each, the index of its type name, and
+	/// the offset of its name in the strings. The name offsets have
+	/// one more entry, at the end.
+	struct Nodes
+	{
+		Table<uint32_t> _type;
+		Table<uint64_t> _name;
+	};
+	Nodes _points;
+	Nodes _link_types;
+	Nodes _poles;
+	Nodes _key;
+
+	Table<Id> _con_pole;
+
+	// Point IDs, sorted by type, then by name.
+	Table<Id> _point_order;
+
+	const char* _strings = nullptr;
+	std::vector<Type> _types;
+
+	~Mapped() { if (_base) munmap(_base, _length); }
+
+	const char* name(const Nodes& nds, Id i, size_t& len) const
+	{
+		len = nds._name[i+1] - nds._name[i];
+		return _strings + nds._name[i];
+	}
+	Handle node(AtomSpace* as, const Nodes& nds, Id i) const
+	{
+		size_t len;
+		const char* nm = name(nds, i, len);
+		return as->add_node(_types[nds._type[i]], std::string(nm, len));
+	}
+};
+
+// ===============================================================
+
+CompactLexis::CompactLexis(const Dictionary& dict)
+	: _as(nullptr), _signature(0)
+{
+	// Number the points and the sections, in dictionary order.
+	// The entry lists are kept as-is, duplicates and all, so that
+	// iterating over them is the same as iterating over
+	// `Dictionary::entries()`.
+	_built.entry_off.push_back(0);
+	for (const auto& pr : dict.lexis())
+	{
+		_point_ids[pr.first] = _points.size();
+		_points.push_back(pr.first);
+
+		for (const Handle& sect : pr.second)
+		{
+			auto fnd = _section_ids.find(sect);
+			if (_section_ids.end() != fnd)
+			{
+				_built.entries.push_back(fnd->second);
+				continue;
+			}
+
+			Id sid = _sections.size();
+			_section_ids[sect] = sid;
+			_sections.push_back(sect);
+			_built.section_point.push_back(_points.size() - 1);
+			_built.entries.push_back(sid);
+		}
+		_built.entry_off.push_back(_built.entries.size());
+	}
+
+	// The connectors of each section.
+	_built.disjunct_off.push_back(0);
+	for (const Handle& sect : _sections)
+	{
+		const Handle& disj = sect->getOutgoingAtom(1);
+		for (const Handle& con : disj->getOutgoingSet())
+			_built.disjuncts.push_back(add_connector(con));
+		_built.disjunct_off.push_back(_built.disjuncts.size());
+	}
+
+	// The joints of each connector. These may be connectors that
+	// do not appear in any section; they are numbered too, and
+	// so this list grows as we walk it.
+	_built.mate_off.push_back(0);
+	for (size_t ic = 0; ic < _connectors.size(); ic++)
+	{
+		for (const Handle& mate : dict.joints(_connectors[ic]))
+			_built.mates.push_back(add_connector(mate));
+		_built.mate_off.push_back(_built.mates.size());
+	}
+
+	// The sections holding each connector.
+	_built.connectable_off.push_back(0);
+	for (const Handle& con : _connectors)
+	{
+		for (const Handle& sect : dict.connectables(con))
+			_built.connectables.push_back(_section_ids.at(sect));
+		_built.connectable_off.push_back(_built.connectables.size());
+	}
+
+	_built.weights.resize(_sections.size(), 0.0);
+	bind();
+}
+
+CompactLexis::~CompactLexis()
+{
+}
+
+/// Point the tables at the built vectors.
+void CompactLexis::bind(void)
+{
+	_section_point.bind(_built.section_point);
+	_con_type.bind(_built.con_type);
+	_disjunct_off.bind(_built.disjunct_off);
+	_disjuncts.bind(_built.disjuncts);
+	_mate_off.bind(_built.mate_off);
+	_mates.bind(_built.mates);
+	_connectable_off.bind(_built.connectable_off);
+	_connectables.bind(_built.connectables);
+	_entry_off.bind(_built.entry_off);
+	_entries.bind(_built.entries);
+	_weights.bind(_built.weights);
+}
+
+/// Number the connector, if it's not been seen before.
+CompactLexis::Id CompactLexis::add_connector(const Handle& con)
+{
+	auto fnd = _connector_ids.find(con);
+	if (_connector_ids.end() != fnd) return fnd->second;
+
+	if (CONNECTOR != con->get_type())
+		throw RuntimeException(TRACE_INFO,
+			"Expecting a Connector in the lexis, got %s",
+				con->to_string().c_str());
+
+	const Handle& linkty = con->getOutgoingAtom(0);
+	auto lit = _link_type_ids.find(linkty);
+	if (_link_type_ids.end() == lit)
+	{
+		lit = _link_type_ids.emplace(linkty, _link_types.size()).first;
+		_link_types.push_back(linkty);
+	}
+
+	Id cid = _connectors.size();
+	_connector_ids[con] = cid;
+	_connectors.push_back(con);
+	_built.con_type.push_back(lit->second);
+	return cid;
+}
+
+void CompactLexis::set_weights(const Handle& key)
+{
+	// The mapped weights are good, if they are for this key.
+	if (_map and 1 == _map->_key._type.size() and
+	    *_map->node(_as, _map->_key, 0) == *key)
+	{
+		_weight_key = key;
+		return;
+	}
+
+	_built.weights.resize(num_sections());
+	for (size_t is = 0; is < num_sections(); is++)
+	{
+		FloatValuePtr fvp(FloatValueCast(section(is)->getValue(key)));
+		_built.weights[is] = fvp ? fvp->value()[0] : 0.0;
+	}
+	_weights.bind(_built.weights);
+	_weight_key = key;
+}
+
+CompactLexis::Id CompactLexis::point_id(const Handle& pnt) const
+{
+	if (nullptr == _map)
+	{
+		auto fnd = _point_ids.find(pnt);
+		if (_point_ids.end() == fnd) return NONE;
+		return fnd->second;
+	}
+
+	// Binary search of the sorted point table.
+	if (not pnt->is_node()) return NONE;
+	const std::vector<Type>& types = _map->_types;
+	auto tit = std::find(types.begin(), types.end(), pnt->get_type());
+	if (types.end() == tit) return NONE;
+	uint32_t ty = tit - types.begin();
+	const std::string& name = pnt->get_name();
+
+	const Mapped::Nodes& pts = _map->_points;
+	auto less = [&](Id pid, int) {
+		if (pts._type[pid] != ty) return pts._type[pid] < ty;
+		size_t len;
+		const char* nm = _map->name(pts, pid, len);
+		int cmp = memcmp(nm, name.data(), std::min(len, name.size()));
+		if (0 != cmp) return cmp < 0;
+		return len < name.size();
+	};
+	const Id* begin = _map->_point_order.data();
+	const Id* end = begin + _map->_point_order.size();
+	const Id* fnd = std::lower_bound(begin, end, 0, less);
+	if (end == fnd) return NONE;
+
+	size_t len;
+	const char* nm = _map->name(pts, *fnd, len);
+	if (pts._type[*fnd] != ty or len != name.size() or
+	    0 != memcmp(nm, name.data(), len))
+		return NONE;
+	return *fnd;
+}
+
+// ===============================================================
+// The atoms. When built from a Dictionary, these are all known, and
+// never change; when mapped, each is created the first time it is
+// asked for, under the lock.
+
+const Handle& CompactLexis::point(Id pnt) const
+{
+	if (nullptr == _map) return _points[pnt];
+	std::lock_guard<std::mutex> lck(_atom_mtx);
+	return get_point(pnt);
+}
+
+const Handle& CompactLexis::link_type(Id lty) const
+{
+	if (nullptr == _map) return _link_types[lty];
+	std::lock_guard<std::mutex> lck(_atom_mtx);
+	return get_link_type(lty);
+}
+
+const Handle& CompactLexis::connector(Id con) const
+{
+	if (nullptr == _map) return _connectors[con];
+	std::lock_guard<std::mutex> lck(_atom_mtx);
+	return get_connector(con);
+}
+
+const Handle& CompactLexis::section(Id sect) const
+{
+	if (nullptr == _map) return _sections[sect];
+	std::lock_guard<std::mutex> lck(_atom_mtx);
+	return get_section(sect);
+}
+
+const Handle& CompactLexis::get_point(Id pnt) const
+{
+	Handle& h = _points[pnt];
+	if (nullptr == h) h = _map->node(_as, _map->_points, pnt);
+	return h;
+}
+
+const Handle& CompactLexis::get_link_type(Id lty) const
+{
+	Handle& h = _link_types[lty];
+	if (nullptr == h) h = _map->node(_as, _map->_link_types, lty);
+	return h;
+}
+
+const Handle& CompactLexis::get_connector(Id con) const
+{
+	Handle& h = _connectors[con];
+	if (nullptr == h)
+		h = _as->add_link(CONNECTOR, get_link_type(_con_type[con]),
+			_map->node(_as, _map->_poles, _map->_con_pole[con]));
+	return h;
+}
+
+const Handle& CompactLexis::get_section(Id sect) const
+{
+	Handle& h = _sections[sect];
+	if (nullptr == h)
+	{
+		HandleSeq cons;
+		for (Id con : disjunct(sect)) cons.push_back(get_connector(con));
+		h = _as->add_link(SECTION, get_point(_section_point[sect]),
+			_as->add_link(CONNECTOR_SEQ, std::move(cons)));
+	}
+	return h;
+}
+
+// ===============================================================
+// Saving and mapping.
+
+void CompactLexis::save(const std::string& path, uint64_t signature) const
+{
+	// Number the node types, and gather up the node names.
+	std::map<Type, uint32_t> type_ids;
+	std::string strings;
+	auto add_nodes = [&](const Handle& h, std::vector<uint32_t>& types,
+	                     std::vector<uint64_t>& names)
+	{
+		if (not h->is_node())
+			throw RuntimeException(TRACE_INFO,
+				"Can only save nodes in a compiled lexis, got %s",
+					h->to_string().c_str());
+
+		auto tit = type_ids.emplace(h->get_type(), type_ids.size()).first;
+		types.push_back(tit->second);
+		names.push_back(strings.size());
+		strings += h->get_name();
+	};
+
+	std::vector<uint32_t> point_type, lt_type, pole_type, key_type;
+	std::vector<uint64_t> point_name, lt_name, pole_name, key_name;
+
+	for (Id ip = 0; ip < num_points(); ip++)
+		add_nodes(point(ip), point_type, point_name);
+	point_name.push_back(strings.size());
+
+	std::vector<Id> point_order(num_points());
+	for (Id ip = 0; ip < num_points(); ip++) point_order[ip] = ip;
+	std::sort(point_order.begin(), point_order.end(), [&](Id a, Id b) {
+		if (point_type[a] != point_type[b])
+			return point_type[a] < point_type[b];
+		return strings.compare(point_name[a], point_name[a+1] - point_name[a],
+			strings, point_name[b], point_name[b+1] - point_name[b]) < 0;
+	});
+
+	size_t num_link_types = 0;
+	for (Id ic = 0; ic < num_connectors(); ic++)
+		num_link_types = std::max(num_link_types, (size_t) _con_type[ic] + 1);
+	for (Id lt = 0; lt < num_link_types; lt++)
+		add_nodes(link_type(lt), lt_type, lt_name);
+	lt_name.push_back(strings.size());
+
+	std::map<Handle, Id> pole_ids;
+	std::vector<Id> con_pole;
+	for (Id ic = 0; ic < num_connectors(); ic++)
+	{
+		const Handle& pole = connector(ic)->getOutgoingAtom(1);
+		auto pit = pole_ids.emplace(pole, pole_ids.size());
+		if (pit.second) add_nodes(pole, pole_type, pole_name);
+		con_pole.push_back(pit.first->second);
+	}
+	pole_name.push_back(strings.size());
+
+	if (_weight_key)
+	{
+		add_nodes(_weight_key, key_type, key_name);
+		key_name.push_back(strings.size());
+	}
+
+	std::vector<uint64_t> type_name;
+	std::vector<std::string> tnames(type_ids.size());
+	for (const auto& pr : type_ids)
+		tnames[pr.second] = nameserver().getTypeName(pr.first);
+	for (const std::string& tn : tnames)
+	{
+		type_name.push_back(strings.size());
+		strings += tn;
+	}
+	type_name.push_back(strings.size());
+
+	// Lay out the blocks.
+	Header hdr;
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, MAGIC, sizeof(MAGIC));
+	hdr.version = VERSION;
+	hdr.byte_order = ENDIAN_MARK;
+	hdr.id_size = sizeof(Id);
+	hdr.num_blocks = NUM_BLOCKS;
+	hdr.signature = signature;
+
+	const void* data[NUM_BLOCKS];
+	auto put = [&](Block blk, const void* ptr, size_t count) {
+		data[blk] = ptr;
+		hdr.count[blk] = count;
+	};
+	put(SECTION_POINT, _section_point.data(), _section_point.size());
+	put(CON_TYPE, _con_type.data(), _con_type.size());
+	put(CON_POLE, con_pole.data(), con_pole.size());
+	put(DISJUNCT_OFF, _disjunct_off.data(), _disjunct_off.size());
+	put(DISJUNCTS, _disjuncts.data(), _disjuncts.size());
+	put(MATE_OFF, _mate_off.data(), _mate_off.size());
+	put(MATES, _mates.data(), _mates.size());
+	put(CONNECTABLE_OFF, _connectable_off.data(), _connectable_off.size());
+	put(CONNECTABLES, _connectables.data(), _connectables.size());
+	put(ENTRY_OFF, _entry_off.data(), _entry_off.size());
+	put(ENTRIES, _entries.data(), _entries.size());
+	put(WEIGHTS, _weights.data(), _weights.size());
+	put(POINT_TYPE, point_type.data(), point_type.size());
+	put(POINT_NAME, point_name.data(), point_name.size());
+	put(POINT_ORDER, point_order.data(), point_order.size());
+	put(LINK_TYPE_TYPE, lt_type.data(), lt_type.size());
+	put(LINK_TYPE_NAME, lt_name.data(), lt_name.size());
+	put(POLE_TYPE, pole_type.data(), pole_type.size());
+	put(POLE_NAME, pole_name.data(), pole_name.size());
+	put(KEY_TYPE, key_type.data(), key_type.size());
+	put(KEY_NAME, key_name.data(), key_name.size());
+	put(TYPE_NAME, type_name.data(), type_name.size());
+	put(STRINGS, strings.data(), strings.size());
+
+	size_t off = align8(sizeof(hdr));
+	for (int blk = 0; blk < NUM_BLOCKS; blk++)
+	{
+		hdr.offset[blk] = off;
+		off = align8(off + hdr.count[blk] * elt_size(blk));
+	}
+
+	// Write to a temporary file, and move it into place, so that
+	// processes that have the old file mapped are not disturbed. The
+	// temporary file has a unique name, in the same directory, so
+	// that concurrent saves to the same path do not clash; the last
+	// one to finish wins.
+	std::string tmp = path + ".XXXXXX";
+	int fd = mkstemp(&tmp[0]);
+	FILE* fh = (0 <= fd) ? fdopen(fd, "wb") : nullptr;
+	if (nullptr == fh)
+	{
+		int err = errno;
+		if (0 <= fd) { close(fd); unlink(tmp.c_str()); }
+		throw RuntimeException(TRACE_INFO,
+			"Cannot write lexis file %s: %s", path.c_str(), strerror(err));
+	}
+
+	// mkstemp makes the file private; the lexis is meant to be shared.
+	fchmod(fd, 0644);
+
+	bool ok = (1 == fwrite(&hdr, sizeof(hdr), 1, fh));
+	static const char zeros[8] = {0};
+	size_t at = sizeof(hdr);
+	for (int blk = 0; ok and blk < NUM_BLOCKS; blk++)
+	{
+		ok = (hdr.offset[blk] - at ==
+			fwrite(zeros, 1, hdr.offset[blk] - at, fh));
+		size_t len = hdr.count[blk] * elt_size(blk);
+		if (ok and 0 < len) ok = (len == fwrite(data[blk], 1, len, fh));
+		at = hdr.offset[blk] + len;
+	}
+
+	// Keep the errno of the first failure; fclose() and unlink() may
+	// overwrite it.
+	int err = ok ? 0 : errno;
+	if (0 != fclose(fh) and ok)
+	{
+		ok = false;
+		err = errno;
+	}
+	if (ok and 0 != rename(tmp.c_str(), path.c_str()))
+	{
+		ok = false;
+		err = errno;
+	}
+	if (not ok)
+	{
+		unlink(tmp.c_str());
+		throw RuntimeException(TRACE_INFO,
+			"Failed to write lexis file %s: %s", path.c_str(), strerror(err));
+	}
+}
+
+CompactLexis::CompactLexis(AtomSpace* as, const std::string& path)
+	: _as(as), _map(new Mapped), _signature(0)
+{
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		throw RuntimeException(TRACE_INFO,
+			"Cannot open lexis file %s: %s", path.c_str(), strerror(errno));
+
+	struct stat st;
+	if (0 != fstat(fd, &st) or (size_t) st.st_size < sizeof(Header))
+	{
+		close(fd);
+		throw RuntimeException(TRACE_INFO,
+			"Not a lexis file: %s", path.c_str());
+	}
+
+	void* base = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (MAP_FAILED == base)
+		throw RuntimeException(TRACE_INFO,
+			"Cannot map lexis file %s: %s", path.c_str(), strerror(errno));
+	_map->_base = base;
+	_map->_length = st.st_size;
+
+	const Header* hdr = (const Header*) base;
+	if (0 != memcmp(hdr->magic, MAGIC, sizeof(MAGIC)))
+		throw RuntimeException(TRACE_INFO,
+			"Not a lexis file: %s", path.c_str());
+	if (VERSION != hdr->version or ENDIAN_MARK != hdr->byte_order or
+	    sizeof(Id) != hdr->id_size or NUM_BLOCKS != hdr->num_blocks)
+		throw RuntimeException(TRACE_INFO,
+			"Lexis file %s is version %u; expecting version %u, "
+			"on a machine of the same byte order",
+			path.c_str(), hdr->version, VERSION);
+
+	_signature = hdr->signature;
+
+	const char* bytes = (const char*) base;
+	for (int blk = 0; blk < NUM_BLOCKS; blk++)
+	{
+		if (0 != hdr->offset[blk] % 8 or
+		    _map->_length < hdr->offset[blk] or
+		    (_map->_length - hdr->offset[blk]) / elt_size(blk) < hdr->count[blk])
+			throw RuntimeException(TRACE_INFO,
+				"Lexis file %s is truncated", path.c_str());
+	}
+	auto get = [&](auto& tbl, Block blk) {
+		tbl._data = (decltype(tbl._data)) (bytes + hdr->offset[blk]);
+		tbl._size = hdr->count[blk];
+	};
+	get(_section_point, SECTION_POINT);
+	get(_con_type, CON_TYPE);
+	get(_map->_con_pole, CON_POLE);
+	get(_disjunct_off, DISJUNCT_OFF);
+	get(_disjuncts, DISJUNCTS);
+	get(_mate_off, MATE_OFF);
+	get(_mates, MATES);
+	get(_connectable_off, CONNECTABLE_OFF);
+	get(_connectables, CONNECTABLES);
+	get(_entry_off, ENTRY_OFF);
+	get(_entries, ENTRIES);
+	get(_weights, WEIGHTS);
+	get(_map->_points._type, POINT_TYPE);
+	get(_map->_points._name, POINT_NAME);
+	get(_map->_point_order, POINT_ORDER);
+	get(_map->_link_types._type, LINK_TYPE_TYPE);
+	get(_map->_link_types._name, LINK_TYPE_NAME);
+	get(_map->_poles._type, POLE_TYPE);
+	get(_map->_poles._name, POLE_NAME);
+	get(_map->_key._type, KEY_TYPE);
+	get(_map->_key._name, KEY_NAME);
+	_map->_strings = bytes + hdr->offset[STRINGS];
+
+	// The type numbers, from their names.
+	Table<uint64_t> tnames;
+	get(tnames, TYPE_NAME);
+	for (size_t it = 0; it + 1 < tnames.size(); it++)
+		if (tnames[it+1] < tnames[it] or
+		    hdr->count[STRINGS] < tnames[it+1])
+			throw RuntimeException(TRACE_INFO,
+				"Lexis file %s is damaged: bad type names", path.c_str());
+	for (size_t it = 0; it + 1 < tnames.size(); it++)
+	{
+		std::string tn(_map->_strings + tnames[it], tnames[it+1] - tnames[it]);
+		Type t = nameserver().getType(tn);
+		if (NOTYPE == t)
+			throw RuntimeException(TRACE_INFO,
+				"Lexis file %s has unknown atom type %s",
+				path.c_str(), tn.c_str());
+		_map->_types.push_back(t);
+	}
+
+	validate(path);
+
+	_points.resize(num_points());
+	_sections.resize(num_sections());
+	_connectors.resize(num_connectors());
+	_link_types.resize(_map->_link_types._type.size());
+}
+
+/// Check that the mapped tables are consistent with one another, so
+/// that no lookup can land outside of the file: the offset tables
+/// run from zero up to the length of the lists they index, and every
+/// ID is less than the number of things it numbers. A truncated or
+/// damaged file, or one written by something else, is rejected here.
+void CompactLexis::validate(const std::string& path) const
+{
+	auto fail = [&](const char* what) {
+		throw RuntimeException(TRACE_INFO,
+			"Lexis file %s is damaged: bad %s", path.c_str(), what);
+	};
+
+	// One offset per ID, plus one at the end.
+	auto offsets = [&](const Table<Id>& off, size_t nids,
+	                   const Table<Id>& vec, const char* what) {
+		if (off.size() != nids + 1 or 0 != off[0] or
+		    vec.size() != off[nids])
+			fail(what);
+		for (size_t i = 0; i < nids; i++)
+			if (off[i+1] < off[i]) fail(what);
+	};
+	auto ids = [&](const Table<Id>& vec, size_t count, const char* what) {
+		for (size_t i = 0; i < vec.size(); i++)
+			if (count <= vec[i]) fail(what);
+	};
+
+	// The node names lie within the strings, in order, and the
+	// types are among those named in the file.
+	const Mapped& mp = *_map;
+	size_t num_strings = ((const Header*) mp._base)->count[STRINGS];
+	auto nodes = [&](const Mapped::Nodes& nds, const char* what) {
+		if (nds._name.size() != nds._type.size() + 1 and
+		    not (0 == nds._type.size() and 0 == nds._name.size()))
+			fail(what);
+		for (size_t i = 0; i < nds._type.size(); i++)
+			if (mp._types.size() <= nds._type[i] or
+			    nds._name[i+1] < nds._name[i])
+				fail(what);
+		if (0 < nds._name.size() and
+		    num_strings < nds._name[nds._name.size() - 1])
+			fail(what);
+	};
+
+	if (0 == _entry_off.size()) fail("point table");
+	size_t npts = num_points();
+	size_t nsects = num_sections();
+	size_t ncons = num_connectors();
+	size_t nltys = mp._link_types._type.size();
+	size_t npoles = mp._poles._type.size();
+
+	offsets(_entry_off, npts, _entries, "entries");
+	offsets(_disjunct_off, nsects, _disjuncts, "disjuncts");
+	offsets(_mate_off, ncons, _mates, "joints");
+	offsets(_connectable_off, ncons, _connectables, "connectables");
+
+	ids(_entries, nsects, "entries");
+	ids(_section_point, npts, "section points");
+	ids(_disjuncts, ncons, "disjuncts");
+	ids(_mates, ncons, "joints");
+	ids(_connectables, nsects, "connectables");
+	ids(_con_type, nltys, "link types");
+	ids(mp._con_pole, npoles, "poles");
+	ids(mp._point_order, npts, "point order");
+
+	if (mp._con_pole.size() != ncons) fail("poles");
+	if (mp._point_order.size() != npts) fail("point order");
+	if (_weights.size() != nsects) fail("weights");
+	if (1 < mp._key._type.size()) fail("weight key");
+
+	if (mp._points._type.size() != npts) fail("points");
+	nodes(mp._points, "points");
+	nodes(mp._link_types, "link types");
+	nodes(mp._poles, "poles");
+	nodes(mp._key, "weight key");
+}
+
+// ========================== END OF FILE ==========================
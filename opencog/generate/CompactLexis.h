@@ -0,0 +1,233 @@
+/*
+ * opencog/generate/CompactLexis.h
+ *
+ * Copyright (C) 2020 Linas Vepstas <linasvepstas@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_COMPACT_LEXIS_H
+#define _OPENCOG_COMPACT_LEXIS_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/generate/Dictionary.h>
+
+namespace opencog
+{
+/** \addtogroup grp_generate
+ *  @{
+ */
+
+/// A Dictionary, flattened into integer tables. Each point, section,
+/// connector and link type in the dictionary is given a small dense
+/// integer ID; the lookups provided by the Dictionary are then just
+/// index ranges into flat arrays. This is what the `CompactAggregate`
+/// runs on: it never has to touch an atom, until a solution is found.
+///
+/// The tables are a snapshot: changes made to the Dictionary after
+/// this is built are not seen.
+///
+/// The tables can be saved to a file, with `save()`, and that file
+/// used later, in place of the Dictionary. The file is mapped into
+/// memory, and the tables are used where they lie; nothing is read
+/// or decoded up front, and processes that map the same file share
+/// one copy of it. The atoms for the points, connectors and sections
+/// are created only when asked for.
+///
+/// Once built or mapped, and its weights set, a CompactLexis may be
+/// shared by several threads.
+class CompactLexis
+{
+public:
+	typedef uint32_t Id;
+	static const Id NONE = UINT32_MAX;
+
+	/// An index range into one of the flat arrays.
+	struct Range
+	{
+		const Id* _begin;
+		const Id* _end;
+		const Id* begin(void) const { return _begin; }
+		const Id* end(void) const { return _end; }
+		size_t size(void) const { return _end - _begin; }
+		Id operator[](size_t i) const { return _begin[i]; }
+	};
+
+private:
+	/// A read-only array; either the contents of a vector, or a
+	/// part of the mapped file.
+	template<typename T>
+	struct Table
+	{
+		const T* _data = nullptr;
+		size_t _size = 0;
+		void bind(const std::vector<T>& v) { _data = v.data(); _size = v.size(); }
+		const T* data(void) const { return _data; }
+		size_t size(void) const { return _size; }
+		const T& operator[](size_t i) const { return _data[i]; }
+	};
+
+	// The atoms that the IDs stand for. When mapped from a file, these
+	// are filled in when first asked for, under the lock, as one
+	// CompactLexis may be shared by several threads.
+	AtomSpace* _as;
+	mutable std::mutex _atom_mtx;
+	mutable HandleSeq _points;
+	mutable HandleSeq _sections;
+	mutable HandleSeq _connectors;
+	mutable HandleSeq _link_types;
+
+	std::map<Handle, Id> _point_ids;
+	std::map<Handle, Id> _section_ids;
+	std::map<Handle, Id> _connector_ids;
+	std::map<Handle, Id> _link_type_ids;
+
+	// The tables, when built from a Dictionary.
+	struct Built
+	{
+		std::vector<Id> section_point;
+		std::vector<Id> con_type;
+		std::vector<Id> disjunct_off;
+		std::vector<Id> disjuncts;
+		std::vector<Id> mate_off;
+		std::vector<Id> mates;
+		std::vector<Id> connectable_off;
+		std::vector<Id> connectables;
+		std::vector<Id> entry_off;
+		std::vector<Id> entries;
+		std::vector<double> weights;
+	};
+	Built _built;
+
+	// Section ID to point ID.
+	Table<Id> _section_point;
+
+	// Connector ID to link type ID.
+	Table<Id> _con_type;
+
+	// The tables proper. Each is a pair of arrays: the offsets, one
+	// per ID (plus one at the end), and the concatenated lists.
+	Table<Id> _disjunct_off;    // section -> its connectors
+	Table<Id> _disjuncts;
+	Table<Id> _mate_off;        // connector -> joints
+	Table<Id> _mates;
+	Table<Id> _connectable_off; // connector -> sections
+	Table<Id> _connectables;
+	Table<Id> _entry_off;       // point -> sections
+	Table<Id> _entries;
+
+	// Section weights, if any.
+	Table<double> _weights;
+
+	// The mapped file, if any, and what is in it, beyond the above.
+	struct Mapped;
+	std::unique_ptr<Mapped> _map;
+
+	Id add_connector(const Handle&);
+	void bind(void);
+	void validate(const std::string&) const;
+
+	// Same as the public lookups, without the lock.
+	const Handle& get_point(Id) const;
+	const Handle& get_link_type(Id) const;
+	const Handle& get_connector(Id) const;
+	const Handle& get_section(Id) const;
+	Range range(const Table<Id>& off, const Table<Id>& vec, Id i) const {
+		return {vec.data() + off[i], vec.data() + off[i+1]};
+	}
+
+	// The key that the weights were loaded from.
+	Handle _weight_key;
+
+	// The signature of the mapped file.
+	uint64_t _signature;
+
+public:
+	CompactLexis(const Dictionary&);
+
+	/// Map the file `path`, written by `save()`. The atoms are
+	/// created in `as`, when needed. Throws if the file cannot be
+	/// read, was written by another version of this code, or if
+	/// its tables are not consistent.
+	CompactLexis(AtomSpace* as, const std::string& path);
+	~CompactLexis();
+
+	CompactLexis(const CompactLexis&) = delete;
+	CompactLexis& operator=(const CompactLexis&) = delete;
+
+	/// Write the tables, and the weights, to the file `path`. The
+	/// points, link types and poles must be nodes. The `signature`
+	/// is kept in the file, for `signature()` to return; it is up to
+	/// the user to say what it means, e.g. a hash of where the lexis
+	/// came from, so that a file made from something else, or from
+	/// an older lexis, can be recognized.
+	void save(const std::string& path, uint64_t signature = 0) const;
+
+	/// The signature that the mapped file was saved with; zero, if
+	/// this was not mapped from a file.
+	uint64_t signature(void) const { return _signature; }
+
+	/// Load the section weights from the FloatValue at `key`.
+	/// Sections without one get a weight of zero. When mapped from
+	/// a file, the weights in the file are kept, if they were saved
+	/// under the same key.
+	void set_weights(const Handle&);
+
+	size_t num_points(void) const { return _entry_off.size() - 1; }
+	size_t num_sections(void) const { return _section_point.size(); }
+	size_t num_connectors(void) const { return _con_type.size(); }
+
+	/// Return the ID of the point, or NONE if it is not in the lexis.
+	Id point_id(const Handle&) const;
+
+	const Handle& point(Id pnt) const;
+	const Handle& section(Id sect) const;
+	const Handle& connector(Id con) const;
+	const Handle& link_type(Id lty) const;
+
+	Id section_point(Id sect) const { return _section_point[sect]; }
+	Id con_type(Id con) const { return _con_type[con]; }
+	double weight(Id sect) const { return _weights[sect]; }
+
+	/// The connectors of a section, in order.
+	Range disjunct(Id sect) const {
+		return range(_disjunct_off, _disjuncts, sect);
+	}
+
+	/// Same as `Dictionary::joints()`
+	Range joints(Id con) const { return range(_mate_off, _mates, con); }
+
+	/// Same as `Dictionary::connectables()`
+	Range connectables(Id con) const {
+		return range(_connectable_off, _connectables, con);
+	}
+
+	/// Same as `Dictionary::entries()`
+	Range entries(Id pnt) const { return range(_entry_off, _entries, pnt); }
+};
+
+
+/** @}*/
+}  // namespace opencog
+
+#endif // _OPENCOG_COMPACT_LEXIS_H
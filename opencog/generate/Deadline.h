@@ -0,0 +1,85 @@
+/*
+ * opencog/generate/Deadline.h
+ *
+ * Copyright (C) 2020 Linas Vepstas <linasvepstas@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_DEADLINE_H
+#define _OPENCOG_DEADLINE_H
+
+#include <atomic>
+#include <chrono>
+
+#include <opencog/util/Logger.h>
+#include <opencog/generate/GenerateCallback.h>
+
+namespace opencog
+{
+/** \addtogroup grp_generate
+ *  @{
+ */
+
+/// The wall-clock limit and the cancellation flag of a search, as
+/// given by the `max_time` and `cancel` parameters of the callback.
+/// The aggregators start it when they start searching, and check it
+/// before each step. Once it has expired, it stays expired.
+class Deadline
+{
+	typedef std::chrono::steady_clock Clock;
+
+	Clock::time_point _end;
+	bool _timed;
+	const std::atomic<bool>* _cancel;
+	bool _expired;
+
+public:
+	Deadline() : _timed(false), _cancel(nullptr), _expired(false) {}
+
+	void start(const GenerateCallback& cb)
+	{
+		_timed = (0.0 < cb.max_time);
+		if (_timed)
+			_end = Clock::now() +
+				std::chrono::duration_cast<Clock::duration>(
+					std::chrono::duration<double>(cb.max_time));
+		_cancel = cb.cancel;
+		_expired = false;
+	}
+
+	bool expired(void)
+	{
+		if (_expired) return true;
+		if (_cancel and _cancel->load(std::memory_order_relaxed))
+		{
+			logger().info("Search cancelled");
+			_expired = true;
+		}
+		else if (_timed and _end <= Clock::now())
+		{
+			logger().info("Search ran out of time");
+			_expired = true;
+		}
+		return _expired;
+	}
+};
+
+
+/** @}*/
+}  // namespace opencog
+
+#endif // _OPENCOG_DEADLINE_H
@@ -19,8 +19,10 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <algorithm>
 #include <random>
 
+#include <opencog/util/Logger.h>
 #include <opencog/atoms/base/Link.h>
 #include <opencog/atoms/value/FloatValue.h>
 
@@ -39,39 +41,76 @@ void Dictionary::add_pole_pair(const Handle& fm_pole,
                                const Handle& to_pole)
 {
 	_pole_pairs.push_back({fm_pole, to_pole});
+
+	// The mates of the connectors seen so far may have changed.
+	for (auto& pr : _mates)
+		pr.second = find_mates(pr.first);
 }
 
 /// Given the Connector `from_con`, return a list of Connectors
-/// that it can attach to.
-HandleSeq Dictionary::joints(const Handle& from_con) const
+/// that it can attach to. The list is empty if the connector is not
+/// in the lexis.
+const HandleSeq& Dictionary::joints(const Handle& from_con) const
 {
-	HandleSeq phs;
+	static const HandleSeq empty;
 
-	// Nothing to do, if not a connector.
-	// XXX FIXME. I think we should be asserting here.
-	// Or at least throwing.
-	if (CONNECTOR != from_con->get_type()) return phs;
+	const auto& fnd = _mates.find(from_con);
+	if (_mates.end() == fnd) return empty;
 
-	// Assume only one pole per connector.
-	Handle from_pole = from_con->getOutgoingAtom(1);
-	Handle to_pole;
-	for (const HandlePair& popr: _pole_pairs)
-		if (from_pole == popr.first) { to_pole = popr.second; break; }
+	return fnd->second;
+}
 
-	// A matching pole was not found.
-	if (!to_pole) return phs;
+/// Search the pole pairs for the mates of the connector `from_con`.
+/// A mate has the same link type and a pairing pole, and must exist
+/// in the AtomSpace.
+HandleSeq Dictionary::find_mates(const Handle& from_con) const
+{
+	HandleSeq phs;
 
 	// Link type of the desired link to make...
-	Handle linkty = from_con->getOutgoingAtom(0);
+	const Handle& linkty = from_con->getOutgoingAtom(0);
+	const Handle& from_pole = from_con->getOutgoingAtom(1);
+	for (const HandlePair& popr: _pole_pairs)
+	{
+		if (from_pole != popr.first) continue;
 
-	// Find appropriate connector, if it exists.
-	Handle matching = _as->get_atom(createLink(CONNECTOR, linkty, to_pole));
-	if (matching)
-		phs.push_back(matching);
+		// Find appropriate connector, if it exists.
+		Handle matching =
+			_as->get_atom(createLink(CONNECTOR, linkty, popr.second));
+		if (matching and phs.end() == std::find(phs.begin(), phs.end(), matching))
+			phs.push_back(matching);
+	}
 
 	return phs;
 }
 
+/// Add the connector `con` to the table of mates, if it is not
+/// there yet. It may also be the mate of connectors already in the
+/// table, if it was not yet in the AtomSpace when they were added.
+void Dictionary::add_mates(const Handle& con)
+{
+	if (CONNECTOR != con->get_type()) return;
+	if (_mates.end() != _mates.find(con)) return;
+	_mates.emplace(con, find_mates(con));
+
+	const Handle& linkty = con->getOutgoingAtom(0);
+	const Handle& to_pole = con->getOutgoingAtom(1);
+	for (const HandlePair& popr: _pole_pairs)
+	{
+		if (to_pole != popr.second) continue;
+
+		Handle other = _as->get_atom(createLink(CONNECTOR, linkty, popr.first));
+		if (nullptr == other) continue;
+
+		auto fnd = _mates.find(other);
+		if (_mates.end() == fnd) continue;
+
+		HandleSeq& phs = fnd->second;
+		if (phs.end() == std::find(phs.begin(), phs.end(), con))
+			phs.push_back(con);
+	}
+}
+
 // ===============================================================
 // Section stuff.
 
@@ -88,12 +127,13 @@ void Dictionary::add_to_lexis(const Handle& sect)
 	// access... Just sayin...
 	//
 
+	// Each section is added only once.
+	if (not _sections.insert(sect).second) return;
+
 	// First lookup table: given a point, create a list of all the
 	// sections it belongs to.
 	Handle point = sect->getOutgoingAtom(0);
-	HandleSeq slist = _entries[point];
-	slist.push_back(sect);
-	_entries[point] = slist;
+	_entries[point].push_back(sect);
 
 	// Second lookup table: given a connector, we can lookup a list
 	// of sections that have that connector in it. We're using a
@@ -103,16 +143,112 @@ void Dictionary::add_to_lexis(const Handle& sect)
 	Handle con_seq = sect->getOutgoingAtom(1);
 	for (const Handle& con : con_seq->getOutgoingSet())
 	{
-		HandleSeq sect_list = _connectables[con];
+		HandleSeq& sect_list = _connectables[con];
 
-		// Only allow unique entries
-		auto found = std::find(sect_list.begin(), sect_list.end(), sect);
-		if (sect_list.end() == found)
-		{
+		// Only allow unique entries. A connector may appear several
+		// times in one section; the section was then just added.
+		if (0 == sect_list.size() or sect_list.back() != sect)
 			sect_list.push_back(sect);
-			_connectables[con] = sect_list;
+
+		add_mates(con);
+	}
+
+	tabulate(sect, false);
+	forget(sect, Handle::UNDEFINED);
+}
+
+/// remove_from_lexis() - Undo `add_to_lexis()`. The order of the
+/// remaining sections is not changed. The connectors that are left
+/// in no section are removed from the table of mates, as if they had
+/// never been added; they stay in the lists of mates of others.
+bool Dictionary::remove_from_lexis(const Handle& sect)
+{
+	if (0 == _sections.erase(sect)) return false;
+
+	auto drop = [&](HandleSeq& seq) {
+		seq.erase(std::remove(seq.begin(), seq.end(), sect), seq.end());
+	};
+
+	auto eit = _entries.find(sect->getOutgoingAtom(0));
+	drop(eit->second);
+	if (0 == eit->second.size()) _entries.erase(eit);
+
+	for (const Handle& con : sect->getOutgoingAtom(1)->getOutgoingSet())
+	{
+		auto cit = _connectables.find(con);
+		if (_connectables.end() == cit) continue;
+		drop(cit->second);
+		if (0 == cit->second.size())
+		{
+			_connectables.erase(cit);
+			_mates.erase(con);
 		}
 	}
+
+	tabulate(sect, true);
+	forget(sect, Handle::UNDEFINED);
+	return true;
+}
+
+void Dictionary::set_weight(const Handle& sect, const Handle& key,
+                            double weight)
+{
+	sect->setValue(key, createFloatValue(weight));
+	forget(sect, key);
+}
+
+void Dictionary::add_sampler(const std::shared_ptr<LexisSampler>& smp)
+{
+	_samplers.push_back(smp);
+}
+
+/// Forget the choosers that draw `sect`: those of its point, and of
+/// its connectors. If `key` is given, then only for samplers using
+/// that weight key.
+void Dictionary::forget(const Handle& sect, const Handle& key)
+{
+	for (auto it = _samplers.begin(); it != _samplers.end(); )
+	{
+		std::shared_ptr<LexisSampler> smp(it->lock());
+		if (nullptr == smp) { it = _samplers.erase(it); continue; }
+		it++;
+
+		if (key and key != smp->weight_key()) continue;
+		smp->forget(sect->getOutgoingAtom(0));
+		for (const Handle& con : sect->getOutgoingAtom(1)->getOutgoingSet())
+			smp->forget(con);
+	}
+}
+
+/// Make room for `n` more sections, before adding them in bulk.
+void Dictionary::reserve(size_t n)
+{
+	_sections.reserve(_sections.size() + n);
+}
+
+/// Count the connectors in `sect` in the per-connector tables, or, if
+/// `remove` is set, take them out again. A connector appearing several
+/// times in the section is counted once, with the number of times.
+void Dictionary::tabulate(const Handle& sect, bool remove)
+{
+	auto bump = [&](std::map<Handle, Counts>& tab,
+	                const Handle& con, size_t key)
+	{
+		Counts& cnts = tab[con];
+		if (not remove) { cnts[key] ++; return; }
+
+		auto fnd = cnts.find(key);
+		if (0 == -- fnd->second) cnts.erase(fnd);
+		if (0 == cnts.size()) tab.erase(con);
+	};
+
+	const HandleSeq& conseq = sect->getOutgoingAtom(1)->getOutgoingSet();
+	for (auto it = conseq.begin(); it != conseq.end(); it++)
+	{
+		if (it != std::find(conseq.begin(), it, *it)) continue;
+		bump(_times, *it, std::count(it, conseq.end(), *it));
+		bump(_arities, *it, conseq.size());
+	}
 }
 
 #if NOT_NEEDED_RIGHT_NOW
@@ -169,3 +305,202 @@ const HandleSeq& Dictionary::entries(const Handle& point) const
 
 	return ice->second;
 }
+
+// ===============================================================
+// Pruning.
+
+/// prune() - Remove sections that cannot possibly be used.
+///
+/// This is a multi-pass algorithm, in the style of the Link Grammar
+/// pruning. A section having a connector that cannot be attached to
+/// any (remaining) section can never appear in a finished network,
+/// and so is removed. Removing it may leave connectors on other
+/// sections with nothing to attach to; so this is repeated, until
+/// nothing more is removed. Then, if `roots` is not empty, the
+/// sections that cannot be reached from the sections of the roots,
+/// by following connectors to their joints, are removed as well.
+///
+/// Only the lexis is pruned; the pole pairs are left alone.
+/// The order of the remaining sections is not changed.
+size_t Dictionary::prune(const HandleSet& roots)
+{
+	HandleSet live;
+	for (const auto& pr : _entries)
+		live.insert(pr.second.begin(), pr.second.end());
+	size_t before = live.size();
+
+	// A connector can be attached to, if some joint of it is on a
+	// live section.
+	auto attachable = [&](const Handle& con) {
+		for (const Handle& mate : joints(con))
+			for (const Handle& sect : connectables(mate))
+				if (0 < live.count(sect)) return true;
+		return false;
+	};
+
+	size_t passes = 0;
+	bool changed = true;
+	while (changed)
+	{
+		changed = false;
+		passes ++;
+		for (auto it = live.begin(); it != live.end(); )
+		{
+			bool ok = true;
+			for (const Handle& con : (*it)->getOutgoingAtom(1)->getOutgoingSet())
+			{
+				if (CONNECTOR != con->get_type()) continue;
+				if (not attachable(con)) { ok = false; break; }
+			}
+			if (ok) it++;
+			else { it = live.erase(it); changed = true; }
+		}
+	}
+	size_t unmatched = before - live.size();
+
+	// Walk outwards from the roots.
+	if (0 < roots.size())
+	{
+		HandleSet reached;
+		HandleSeq todo;
+		for (const Handle& root : roots)
+			for (const Handle& sect : entries(root))
+				if (0 < live.count(sect) and reached.insert(sect).second)
+					todo.push_back(sect);
+
+		while (0 < todo.size())
+		{
+			Handle sect = todo.back();
+			todo.pop_back();
+			for (const Handle& con : sect->getOutgoingAtom(1)->getOutgoingSet())
+				for (const Handle& mate : joints(con))
+					for (const Handle& other : connectables(mate))
+						if (0 < live.count(other) and reached.insert(other).second)
+							todo.push_back(other);
+		}
+		live.swap(reached);
+	}
+	size_t unreachable = before - unmatched - live.size();
+
+	keep_only(live);
+
+	logger().info("Pruned lexis in %lu passes: of %lu sections, "
+		"%lu had unattachable connectors, %lu were unreachable; "
+		"%lu remain", passes, before, unmatched, unreachable, live.size());
+
+	return before - live.size();
+}
+
+/// Remove all sections not in `live` from the lookup tables.
+void Dictionary::keep_only(const HandleSet& live)
+{
+	auto dead = [&](const Handle& sect) { return 0 == live.count(sect); };
+	auto trim = [&](auto& map) {
+		for (auto it = map.begin(); it != map.end(); )
+		{
+			HandleSeq& seq = it->second;
+			seq.erase(std::remove_if(seq.begin(), seq.end(), dead), seq.end());
+			if (0 == seq.size()) it = map.erase(it);
+			else it++;
+		}
+	};
+	trim(_entries);
+	trim(_connectables);
+	_sections.clear();
+	_sections.insert(live.begin(), live.end());
+
+	// Connectors no longer in the lexis have no joints, same as in
+	// `remove_from_lexis()`.
+	for (auto it = _mates.begin(); it != _mates.end(); )
+	{
+		if (_connectables.end() == _connectables.find(it->first))
+			it = _mates.erase(it);
+		else it++;
+	}
+
+	_times.clear();
+	_arities.clear();
+	for (const Handle& sect : live)
+		tabulate(sect, false);
+
+	for (const auto& wsmp : _samplers)
+	{
+		std::shared_ptr<LexisSampler> smp(wsmp.lock());
+		if (smp) smp->clear();
+	}
+}
+
+// ===============================================================
+// Bounds.
+
+/// The most times that the connector appears in any one section.
+/// Zero, if it does not appear in any.
+size_t Dictionary::capacity(const Handle& con) const
+{
+	auto fnd = _times.find(con);
+	if (_times.end() == fnd) return 0;
+	return fnd->second.rbegin()->first;
+}
+
+/// The fewest connectors on any section holding the connector.
+/// Zero, if it does not appear in any.
+size_t Dictionary::min_arity(const Handle& con) const
+{
+	auto fnd = _arities.find(con);
+	if (_arities.end() == fnd) return 0;
+	return fnd->second.begin()->first;
+}
+
+/// closing_bounds() - How much more is needed to close the open
+/// connectors.
+///
+/// Every link joins a connector to one of its joints. So, if there
+/// are more open connectors of some kind than there are open joints
+/// for them, then the difference must be made up by new sections
+/// holding the joint. Each such section holds at most `capacity()`
+/// of them, and has at least `min_arity()` connectors in all. A
+/// connector that is its own joint needs a partner too; if there are
+/// an odd number of them, then at least one more is needed.
+///
+/// The new sections might fill the shortfall for several kinds of
+/// connectors at once, and so the largest of the bounds is taken,
+/// not their sum. Connectors that do not have exactly one joint are
+/// skipped; no bound is derived for them.
+bool Dictionary::closing_bounds(const HandleSet& open,
+                                size_t& nsects, size_t& ncons) const
+{
+	nsects = 0;
+	ncons = 0;
+
+	std::map<Handle, size_t> count;
+	for (const Handle& sect : open)
+		for (const Handle& con : sect->getOutgoingAtom(1)->getOutgoingSet())
+			if (CONNECTOR == con->get_type()) count[con] ++;
+
+	for (const auto& pr : count)
+	{
+		const HandleSeq& mates = joints(pr.first);
+		if (1 != mates.size()) continue;
+		const Handle& mate = mates[0];
+
+		size_t short_by = 0;
+		if (mate == pr.first)
+			short_by = pr.second % 2;
+		else
+		{
+			auto fnd = count.find(mate);
+			size_t have = (count.end() == fnd) ? 0 : fnd->second;
+			if (have < pr.second) short_by = pr.second - have;
+		}
+		if (0 == short_by) continue;
+
+		size_t cap = capacity(mate);
+		if (0 == cap) return false;
+
+		size_t ns = (short_by + cap - 1) / cap;
+		size_t nc = ns * min_arity(mate);
+		if (nsects < ns) nsects = ns;
+		if (ncons < nc) ncons = nc;
+	}
+	return true;
+}
@@ -22,7 +22,13 @@
 #ifndef _OPENCOG_DICTIONARY_H
 #define _OPENCOG_DICTIONARY_H
 
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include <opencog/atomspace/AtomSpace.h>
+#include <opencog/generate/LexisSampler.h>
 
 namespace opencog
 {
@@ -50,30 +56,108 @@ class Dictionary
 	/// Pairings of connectors that can joint to one-another.
 	HandlePairSeq _pole_pairs;
 
+	/// Map from Connectors in the lexis to the Connectors that they
+	/// can attach to. A pole may pair with several others, and so a
+	/// connector may have several mates. This is kept up to date as
+	/// sections and pole pairs are added, so that `joints()` is just
+	/// a lookup.
+	std::unordered_map<Handle, HandleSeq> _mates;
+	HandleSeq find_mates(const Handle&) const;
+	void add_mates(const Handle&);
+
+	/// All of the Sections in the lexis; a section is added only once.
+	std::unordered_set<Handle> _sections;
+
 	/// Map from Connectors to Sections that hold that connector.
 	/// This map is set up at the start, before iteration begins.
 	//
-	HandleSeqMap _connectables;
+	std::unordered_map<Handle, HandleSeq> _connectables;
 
 	/// Map from points to Sections rooted at that point.
 	/// This map is set up at the start, before iteration begins.
 	HandleSeqMap _entries;
 
+	/// For each connector, the number of sections holding it so many
+	/// times, and the number of sections holding it, by their arity.
+	/// The largest of the first and the smallest of the second give
+	/// lower bounds on what it takes to close connectors; see
+	/// `closing_bounds()`. Counts, rather than just the bounds, so that
+	/// a section can be taken out again without looking at the others.
+	typedef std::map<size_t, size_t> Counts;
+	std::map<Handle, Counts> _times;
+	std::map<Handle, Counts> _arities;
+
+	void tabulate(const Handle&, bool);
+	void keep_only(const HandleSet&);
+
+	/// The samplers to tell of changes to the lexis. A copy of the
+	/// dictionary starts out with none: the samplers are for the
+	/// original.
+	struct Samplers : std::vector<std::weak_ptr<LexisSampler>>
+	{
+		Samplers(void) {}
+		Samplers(const Samplers&) {}
+		Samplers& operator=(const Samplers&) { clear(); return *this; }
+	};
+	Samplers _samplers;
+	void forget(const Handle&, const Handle&);
+
 public:
 	Dictionary(AtomSpace*);
 
 	void add_pole_pair(const Handle&, const Handle&);
 
-	HandleSeq joints(const Handle&) const;
+	const HandleSeq& joints(const Handle&) const;
 
 	void add_to_lexis(const Handle&);
+	void add_to_lexis(const HandleSeq& lex) {
+		reserve(lex.size());
+		for (const Handle& h: lex) add_to_lexis(h);
+	}
 	void add_to_lexis(const HandleSet& lex) {
+		reserve(lex.size());
 		for (const Handle& h: lex) add_to_lexis(h);
 	}
+	void reserve(size_t);
 	// void sort_lexis(const Handle&);
 
+	/// Remove a section from the lexis. Returns false if it was not
+	/// in the lexis. Only the tables for its point and its connectors
+	/// are updated.
+	bool remove_from_lexis(const Handle&);
+	bool in_lexis(const Handle& sect) const {
+		return 0 < _sections.count(sect);
+	}
+
+	/// Set the weight of the section, at the weight key, to `weight`.
+	/// The choosers that draw the section are forgotten.
+	void set_weight(const Handle& sect, const Handle& key, double weight);
+
+	/// Tell the sampler of changes to the lexis: the choosers that
+	/// draw from the changed lists of sections are forgotten, and
+	/// made again, when next needed. Only the sampler's weight key is
+	/// looked at, for changes in weights. Not kept by copies.
+	void add_sampler(const std::shared_ptr<LexisSampler>&);
+
 	const HandleSeq& connectables(const Handle&) const;
 	const HandleSeq& entries(const Handle&) const;
+
+	/// Remove the sections that can never be a part of a network
+	/// grown from the `roots`. Returns the number removed.
+	size_t prune(const HandleSet& roots);
+
+	size_t capacity(const Handle&) const;
+	size_t min_arity(const Handle&) const;
+
+	/// Lower bounds on closing all of the open connectors on the
+	/// `open` sections: at least `nsects` new sections, holding at
+	/// least `ncons` connectors between them, are needed. Returns
+	/// false if the connectors cannot be closed at all.
+	bool closing_bounds(const HandleSet& open,
+	                    size_t& nsects, size_t& ncons) const;
+
+	/// All of the sections in the lexis, keyed by their point.
+	const HandleSeqMap& lexis(void) const { return _entries; }
 };
 
 
@@ -0,0 +1,67 @@
+/*
+ * opencog/generate/GenerateCallback.cc
+ *
+ * Copyright (C) 2020 Linas Vepstas <linasvepstas@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <opencog/atoms/base/Link.h>
+
+#include "GenerateCallback.h"
+
+using namespace opencog;
+
+/// Lower bounds on the size and depth needed to finish the frame.
+bool GenerateCallback::admissible(const Dictionary& dict,
+                                  const OdoFrame& frm)
+{
+	if (not admissible_bounds) return true;
+
+	size_t nsects, ncons;
+	if (not dict.closing_bounds(frm._open_sections, nsects, ncons))
+		return false;
+
+	size_t size = frm._linkage.size() + frm._open_sections.size();
+	if (max_network_size < size + nsects) return false;
+
+	// At the last level, new connectors can only be closed by the
+	// connectors that are open now.
+	if (max_depth <= frm._nodo)
+	{
+		size_t nopen = 0;
+		for (const Handle& sect : frm._open_sections)
+			for (const Handle& con : sect->getOutgoingAtom(1)->getOutgoingSet())
+				if (CONNECTOR == con->get_type()) nopen ++;
+		if (nopen < ncons) return false;
+	}
+	return true;
+}
+
+/// The lexis sections holding `to_con`, plus the places on the open
+/// sections where it could attach.
+size_t GenerateCallback::count_choices(const Dictionary& dict,
+                                       const OdoFrame& frm,
+                                       const Handle& to_con)
+{
+	size_t nchoices = dict.connectables(to_con).size();
+	for (const Handle& sect : frm._open_sections)
+		for (const Handle& con : sect->getOutgoingAtom(1)->getOutgoingSet())
+			if (*con == *to_con) nchoices ++;
+	return nchoices;
+}
+
+// ========================== END OF FILE ==========================
@@ -22,7 +22,10 @@
 #ifndef _OPENCOG_GENERATE_CALLBACK_H
 #define _OPENCOG_GENERATE_CALLBACK_H
 
+#include <atomic>
+
 #include <opencog/atomspace/AtomSpace.h>
+#include <opencog/generate/Dictionary.h>
 #include <opencog/generate/Odometer.h>
 
 namespace opencog
@@ -51,6 +54,12 @@ class GenerateCallback
 {
 protected:
 	AtomSpace* _as;
+
+	/// The `viable()` and `num_choices()` of callbacks that draw from
+	/// the lexis `dict`; see those.
+	bool admissible(const Dictionary& dict, const OdoFrame&);
+	size_t count_choices(const Dictionary& dict, const OdoFrame&,
+	                     const Handle& to_con);
 public:
 	GenerateCallback(AtomSpace* as) : _as(as) {}
 	virtual ~GenerateCallback() {}
@@ -76,7 +85,9 @@ public:
 	/// Given a connector, return a set of matching connectors
 	/// that this particular connector could connect to. This
 	/// set may be empty, or may contain more than one match.
-	virtual HandleSeq joints(const Handle&) = 0;
+	/// It is called for every open connector, every time that an
+	/// odometer is set up, and so should not need to compute much.
+	virtual const HandleSeq& joints(const Handle&) = 0;
 
 	/// Given an existing connected section `fm_sect` and a connector
 	/// `fm_con` on that section, as well as a mating `to_con`, return
@@ -111,6 +122,13 @@ public:
 	virtual void push_frame(const OdoFrame&) {}
 	virtual void pop_frame(const OdoFrame&) {}
 
+	/// Called after `clear()` by aggregators whose frames outlive
+	/// their pop: those that share the scratch space between threads,
+	/// or keep frames in a population. Until the next `clear()`, the
+	/// atoms made for a frame must not be removed from the scratch
+	/// space when it is popped.
+	virtual void keep_scratch(void) {}
+
 	virtual void push_odometer(const Odometer&) {}
 	virtual void pop_odometer(const Odometer&) {}
 
@@ -122,6 +140,26 @@ public:
 	/// The default below allows infinite recursion.
 	virtual bool step(const OdoFrame&) { return true; }
 
+	/// Called before exploring the frame. Return `false` if the open
+	/// connectors in the frame cannot possibly be closed within the
+	/// limits, so that there is no point in trying. Unlike `step()`,
+	/// this only skips the one frame.
+	virtual bool viable(const OdoFrame&) { return true; }
+
+	/// Return the number of ways of attaching something to `to_con`,
+	/// in this frame: the number of sections, in the lexis and among
+	/// the open sections, that hold it. Used to order the odometer
+	/// wheels, when `most_constrained_first` is set. The default
+	/// treats all connectors alike.
+	virtual size_t num_choices(const OdoFrame&, const Handle& to_con)
+	{ return 0; }
+
+	/// Return the relative weight of a partial assembly, for the
+	/// `PopulationAggregate`: members are drawn for growing in
+	/// proportion to this (times their closability). Zero culls the
+	/// member. The default weighs all of them alike.
+	virtual double fitness(const OdoFrame&) { return 1.0; }
+
 	/// Called when a solution is found. A solution is a linkage,
 	/// with no open connectors.
 	virtual void solution(const OdoFrame&) = 0;
@@ -131,6 +169,13 @@ public:
 	/// maintanence pertaining to reporting the solutions.
 	virtual Handle get_solutions(void) = 0;
 
+	/// Return the number of distinct solutions found so far, and the
+	/// number of odometer steps taken so far. These allow a driver
+	/// running several callbacks (e.g. one per thread) to enforce
+	/// the limits below across all of them.
+	virtual size_t num_solutions(void) { return 0; }
+	virtual size_t num_steps(void) { return 0; }
+
 	// ---------------------------------------------------------------
 	/// Generic Parameters
 	/// These are parameters that all callback systems might reasonably
@@ -170,13 +215,117 @@ public:
 	/// Maximum number of odometer steps to take. This needs to be
 	/// capped, as infinite loops are possible, especially with the
 	/// random selector, which, with approrpaite weightings, can
-	/// explosively create infinite networks. (Its potentially
-	/// possible to determine, in advance, if a given weighting scheme
-	/// will create infinite trees, mon average. But this does not seem
-	/// like a high priority task, right now.
+	/// explosively create infinite networks. Whether a given weighting
+	/// scheme will create infinite trees, on average, can be found in
+	/// advance; see `GrowthAnalysis` and `auto_bounds`.
 	/// (2016 vintage CPU run at approx 1.2K steps/second).
 	size_t max_steps = 25101;
 
+	/// Maximum wall-clock time, in seconds, to search for. Zero means
+	/// no limit. Unlike `max_steps`, this does not depend on how fast
+	/// the machine is. The solutions found so far are kept.
+	double max_time = 0.0;
+
+	/// Cancellation flag. If this is set, and the flag it points at
+	/// becomes true, the search stops at its next step, keeping the
+	/// solutions found so far. The flag is meant to be set from some
+	/// other thread than the one running the search. It is owned by
+	/// the caller, and must outlive the search.
+	std::atomic<bool>* cancel = nullptr;
+
+	/// Number of threads to run, when aggregating in parallel. Each
+	/// thread runs its own copy of the callback; the limits above are
+	/// shared by all of them. See `ParallelAggregate`.
+	size_t num_threads = 1;
+
+	/// Run the `CompactAggregate` instead of the `Aggregate`. It runs
+	/// on integer IDs, creating atoms only for the solutions. It is
+	/// single-threaded, so `num_threads` is ignored when this is set.
+	bool compact_engine = false;
+
+	/// A compiled lexis, for the `compact_engine`: the name of a file
+	/// written by `CompactLexis::save()`. If the file exists, it is
+	/// mapped into memory, and used instead of the dictionary; if not,
+	/// it is written. It is used as-is; it is never pruned, and it is
+	/// not updated when the dictionary changes. Empty if none.
+	std::string lexis_file;
+
+	/// Keep only one solution of each shape. Solutions that differ
+	/// only in the naming of the unique points, but are otherwise
+	/// identical networks (isomorphic graphs, with the same point and
+	/// link types) are reported once. See `Canonical`.
+	bool dedup_isomorphic = false;
+
+	/// Skip odometer states that are mirror images of one another.
+	/// When two open connectors are interchangeable (identical
+	/// connectors on the same section, or on twin sections), only one
+	/// of the ways of attaching lexis sections to them is explored.
+	/// This prunes searches that would otherwise find the same
+	/// network over and over, with the points renamed. It assumes
+	/// that the order of connectors in a section does not matter,
+	/// and is meant for exhaustive search; see `Aggregate`.
+	bool break_symmetry = false;
+
+	/// Number of dead states to remember. A dead state is a set of
+	/// open sections from which the search could not reach any
+	/// solution. The same set, up to the naming of the points, is
+	/// often reached again, by attaching the same pieces in a
+	/// different order; it is then skipped. The depth and the network
+	/// size are part of the state, when `max_depth` or
+	/// `max_network_size` are set. Zero disables this. Meant for
+	/// exhaustive search; a custom `step()` that stops the search for
+	/// other reasons should leave this off. See `TranspositionTable`.
+	size_t memo_size = 0;
+
+	/// Prune the dictionary before starting. Sections that have a
+	/// connector that nothing can attach to, or that cannot be
+	/// reached from the roots, are dropped, before the search begins,
+	/// instead of being discovered, over and over, during the search.
+	/// See `Dictionary::prune()`.
+	bool prune_lexis = false;
+
+	/// Skip frames that cannot be finished within `max_network_size`
+	/// and `max_depth`. The open sections, and the fewest number of
+	/// new sections that must still be added to close them (see
+	/// `Dictionary::closing_bounds()`) are counted towards the network
+	/// size. At the last level allowed by `max_depth`, all of the new
+	/// connectors must be closed by the connectors that are open now.
+	/// Without this, only the finished sections are counted, and
+	/// networks somewhat larger than `max_network_size` can be found.
+	bool admissible_bounds = false;
+
+	/// Lower `max_depth` and `max_network_size` to the bounds that
+	/// `GrowthAnalysis` suggests for the lexis and its weights, before
+	/// starting, so that steps are not wasted on networks that, most
+	/// likely, would never stop growing. Random generation only.
+	bool auto_bounds = false;
+
+	/// Order the odometer wheels by the number of choices they have
+	/// (see `num_choices()`), fewest first, instead of in the order
+	/// in which the open sections happen to be stored. The wheels
+	/// of the most constrained connectors then turn the slowest, so
+	/// that a connector with few ways of being closed is decided
+	/// early, and a dead end is found before, and not after, all of
+	/// the combinations of the other wheels are tried. This changes
+	/// the order in which solutions are found, but not which ones.
+	bool most_constrained_first = false;
+
+	/// Number of partial assemblies to grow side by side, when
+	/// generating randomly. Zero means that the `Aggregate` is used,
+	/// growing one assembly at a time, backtracking when it cannot be
+	/// finished. Otherwise, the `PopulationAggregate` is used, keeping
+	/// this many assemblies, and growing them one layer at a time,
+	/// with no backtracking. It is single-threaded, so `num_threads`
+	/// is ignored when this is set.
+	size_t population_size = 0;
+
+	/// Seed for the random number generators. Zero means a fresh seed
+	/// each time. Otherwise, the generators are re-seeded with this at
+	/// the start of each search, so that the same search makes the
+	/// same draws, and finds the same networks, every time. This holds
+	/// for single-threaded searches only; threads race for the work.
+	unsigned long random_seed = 0;
+
 	/// A location to which all point instances will be anchored.
 	/// Thus, all points can be found by following the MemberLink
 	/// from this anchor point.
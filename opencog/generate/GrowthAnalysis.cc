@@ -0,0 +1,365 @@
+/*
+ * opencog/generate/GrowthAnalysis.cc
+ *
+ * Copyright (C) 2020 Linas Vepstas <linasvepstas@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <opencog/util/Logger.h>
+#include <opencog/atoms/base/Atom.h>
+#include <opencog/atoms/value/FloatValue.h>
+
+#include "GrowthAnalysis.h"
+
+using namespace opencog;
+
+void GrowthStats::print(void) const
+{
+	logger().info("Growth: spectral radius %g, extinction %g; "
+		"size %g +/- %g, depth %g; suggested size %lu, depth %lu",
+		spectral_radius, extinction, mean_size, size_deviation,
+		mean_depth, suggested_size, suggested_depth);
+}
+
+GrowthAnalysis::GrowthAnalysis(const Dictionary& dict,
+                               const Handle& weight_key)
+	: _dict(dict), _weight_key(weight_key)
+{
+}
+
+size_t GrowthAnalysis::con_id(const Handle& con)
+{
+	auto fnd = _con_ids.find(con);
+	if (_con_ids.end() != fnd) return fnd->second;
+
+	size_t id = _cons.size();
+	_con_ids.emplace(con, id);
+	_cons.push_back(con);
+	return id;
+}
+
+/// The draws of one of the `sects`, by weight, as the `RandomCallback`
+/// makes them. The drawn section is attached by the connector `used`,
+/// and so that one is not open; for the roots, it is undefined.
+std::vector<GrowthAnalysis::Draw>
+GrowthAnalysis::draws(const HandleSeq& sects, const Handle& used)
+{
+	std::vector<Draw> drs;
+	double total = 0.0;
+	for (const Handle& sect : sects)
+	{
+		FloatValuePtr fvp(FloatValueCast(sect->getValue(_weight_key)));
+		double weight = fvp ? fvp->value()[0] : 0.0;
+		if (weight <= 0.0) continue;
+		total += weight;
+
+		Draw dr;
+		dr.prob = weight;
+		bool attached = (nullptr == used);
+		for (const Handle& con : sect->getOutgoingAtom(1)->getOutgoingSet())
+		{
+			if (CONNECTOR != con->get_type()) continue;
+			if (not attached and con == used) { attached = true; continue; }
+
+			size_t id = con_id(con);
+			auto off = std::find_if(dr.offspring.begin(), dr.offspring.end(),
+				[&](const std::pair<size_t, size_t>& pr) { return pr.first == id; });
+			if (dr.offspring.end() == off) dr.offspring.push_back({id, 1});
+			else off->second ++;
+		}
+		drs.push_back(dr);
+	}
+
+	for (Draw& dr : drs) dr.prob /= total;
+	return drs;
+}
+
+/// Number the connectors that can be reached from the roots, and
+/// tabulate the ways of closing each of them.
+void GrowthAnalysis::tabulate(const HandleSet& roots)
+{
+	_cons.clear();
+	_con_ids.clear();
+	_draws.clear();
+	_roots.clear();
+
+	for (const Handle& root : roots)
+	{
+		_roots.push_back(draws(_dict.entries(root), Handle::UNDEFINED));
+		if (0 == _roots.back().size())
+			throw RuntimeException(TRACE_INFO,
+				"No weighted dictionary entry for root=%s",
+				root->to_string().c_str());
+	}
+
+	// The connectors are numbered as they are found, and so this is
+	// a breadth-first walk. The odometer has one wheel per joint of a
+	// connector, in the order of `joints()`; the first of them either
+	// closes the connector, or rolls over, and the later ones find it
+	// closed. So only the first joint is ever drawn from.
+	for (size_t id = 0; id < _cons.size(); id++)
+	{
+		Handle con(_cons[id]);
+		const HandleSeq& mates = _dict.joints(con);
+		if (0 == mates.size())
+		{
+			_draws.push_back({});
+			continue;
+		}
+		_draws.push_back(draws(_dict.connectables(mates[0]), mates[0]));
+	}
+}
+
+/// The product of the mean-offspring matrix and the vector `x`: the
+/// expected sum of `x` over the offspring of each connector.
+GrowthAnalysis::Vec GrowthAnalysis::mean_offspring(const Vec& x) const
+{
+	Vec y(_cons.size(), 0.0);
+	for (size_t c = 0; c < _cons.size(); c++)
+		for (const Draw& dr : _draws[c])
+			for (const auto& off : dr.offspring)
+				y[c] += dr.prob * off.second * x[off.first];
+	return y;
+}
+
+/// Solve `x = b + M x`, by iterating it. This converges if the
+/// spectral radius of M is less than one.
+GrowthAnalysis::Vec GrowthAnalysis::solve(const Vec& b) const
+{
+	Vec x(b);
+	for (size_t i = 0; i < max_iterations; i++)
+	{
+		Vec y(mean_offspring(x));
+		double diff = 0.0;
+		double norm = 0.0;
+		for (size_t c = 0; c < y.size(); c++)
+		{
+			y[c] += b[c];
+			diff += std::fabs(y[c] - x[c]);
+			norm += y[c];
+		}
+		x.swap(y);
+		if (diff <= 1e-12 * norm) break;
+	}
+	return x;
+}
+
+/// Power iteration. The matrix is non-negative, and so its spectral
+/// radius is an eigenvalue, with a non-negative eigenvector. The
+/// iteration is done with M + 1, so that it converges even if the
+/// connectors alternate, generation by generation, as do `+` and `-`
+/// connectors.
+double GrowthAnalysis::spectral_radius(void) const
+{
+	size_t n = _cons.size();
+	if (0 == n) return 0.0;
+
+	Vec x(n, 1.0 / n);
+	double rho = 0.0;
+	for (size_t i = 0; i < max_iterations; i++)
+	{
+		Vec y(mean_offspring(x));
+		double norm = 0.0;
+		for (size_t c = 0; c < n; c++)
+		{
+			y[c] += x[c];
+			norm += y[c];
+		}
+		for (size_t c = 0; c < n; c++) y[c] /= norm;
+		x.swap(y);
+
+		double est = norm - 1.0;
+		bool done = std::fabs(est - rho) <= 1e-12 * (1.0 + est);
+		rho = est;
+		if (done) break;
+	}
+	return rho;
+}
+
+/// analyze() - What to expect of the networks grown from the roots.
+///
+/// The depths come from the generating functions: the probability
+/// that all that grows out of a connector stops within k+1
+/// generations is the expected product of the probabilities that
+/// its offspring stop within k. The sizes come from solving the
+/// linear equations for the first and second moments of the number
+/// of sections grown out of each connector.
+GrowthStats GrowthAnalysis::analyze(const HandleSet& roots)
+{
+	tabulate(roots);
+	size_t n = _cons.size();
+	const double inf = std::numeric_limits<double>::infinity();
+
+	GrowthStats gs;
+	gs.spectral_radius = spectral_radius();
+
+	// A connector that cannot be closed adds nothing, and stops at
+	// once.
+	Vec closable(n, 0.0);
+	for (size_t c = 0; c < n; c++)
+		if (0 < _draws[c].size()) closable[c] = 1.0;
+
+	// The probability that the whole network stops within k
+	// generations, given the same for each connector.
+	auto stopped = [&](const Vec& q) {
+		double prob = 1.0;
+		for (const std::vector<Draw>& root : _roots)
+		{
+			double pr = 0.0;
+			for (const Draw& dr : root)
+			{
+				double p = dr.prob;
+				for (const auto& off : dr.offspring)
+					p *= std::pow(q[off.first], off.second);
+				pr += p;
+			}
+			prob *= pr;
+		}
+		return prob;
+	};
+
+	Vec q(n);
+	for (size_t c = 0; c < n; c++) q[c] = 1.0 - closable[c];
+
+	std::vector<double> depth_cdf({stopped(q)});
+	for (size_t k = 0; k < max_iterations; k++)
+	{
+		Vec next(n);
+		double diff = 0.0;
+		for (size_t c = 0; c < n; c++)
+		{
+			if (0 == _draws[c].size()) { next[c] = 1.0; continue; }
+			double p = 0.0;
+			for (const Draw& dr : _draws[c])
+			{
+				double pd = dr.prob;
+				for (const auto& off : dr.offspring)
+					pd *= std::pow(q[off.first], off.second);
+				p += pd;
+			}
+			next[c] = p;
+			diff = std::max(diff, std::fabs(p - q[c]));
+		}
+		q.swap(next);
+		depth_cdf.push_back(stopped(q));
+		if (diff <= 1e-12) break;
+	}
+	gs.extinction = depth_cdf.back();
+
+	// Too few networks stop, for the bounds to mean anything.
+	if (1e-6 < gs.extinction)
+	{
+		double want = coverage * gs.extinction;
+		while (depth_cdf[gs.suggested_depth] < want)
+			gs.suggested_depth ++;
+	}
+
+	if (gs.supercritical())
+	{
+		gs.mean_size = inf;
+		gs.size_deviation = inf;
+		gs.mean_depth = inf;
+		if (0 == gs.suggested_depth) return gs;
+
+		// The expected number of sections grown within the suggested
+		// depth. The networks that keep on growing count too, and so
+		// this is generous.
+		Vec v(n, 0.0);
+		double size = _roots.size();
+		for (const std::vector<Draw>& root : _roots)
+			for (const Draw& dr : root)
+				for (const auto& off : dr.offspring)
+					v[off.first] += dr.prob * off.second;
+		for (size_t k = 0; k < gs.suggested_depth; k++)
+		{
+			Vec next(n, 0.0);
+			for (size_t c = 0; c < n; c++)
+			{
+				size += v[c] * closable[c];
+				for (const Draw& dr : _draws[c])
+					for (const auto& off : dr.offspring)
+						next[off.first] += v[c] * dr.prob * off.second;
+			}
+			v.swap(next);
+		}
+		gs.suggested_size = std::ceil(size);
+		return gs;
+	}
+
+	for (double p : depth_cdf)
+		gs.mean_depth += 1.0 - p;
+
+	// t[c] and s[c] are the first and second moments of the number
+	// of sections grown out of the connector c, itself included.
+	Vec t(solve(closable));
+	Vec mt(mean_offspring(t));
+	Vec a(n);
+	for (size_t c = 0; c < n; c++)
+	{
+		a[c] = closable[c] + 2.0 * mt[c];
+		for (const Draw& dr : _draws[c])
+		{
+			double sum = 0.0, sumsq = 0.0;
+			for (const auto& off : dr.offspring)
+			{
+				sum += off.second * t[off.first];
+				sumsq += off.second * t[off.first] * t[off.first];
+			}
+			a[c] += dr.prob * (sum * sum - sumsq);
+		}
+	}
+	Vec s(solve(a));
+
+	double var = 0.0;
+	for (const std::vector<Draw>& root : _roots)
+	{
+		double mean = 1.0, second = 1.0;
+		for (const Draw& dr : root)
+		{
+			double sum = 0.0, sumsq = 0.0, sums = 0.0;
+			for (const auto& off : dr.offspring)
+			{
+				sum += off.second * t[off.first];
+				sumsq += off.second * t[off.first] * t[off.first];
+				sums += off.second * s[off.first];
+			}
+			mean += dr.prob * sum;
+			second += dr.prob * (2.0 * sum + sums + sum * sum - sumsq);
+		}
+		gs.mean_size += mean;
+		var += second - mean * mean;
+	}
+	gs.size_deviation = std::sqrt(std::max(var, 0.0));
+	if (0 < gs.suggested_depth)
+		gs.suggested_size = std::ceil(gs.mean_size + 3.0 * gs.size_deviation);
+
+	return gs;
+}
+
+void GrowthAnalysis::apply(const GrowthStats& gs, GenerateCallback& cb)
+{
+	if (0 < gs.suggested_depth and gs.suggested_depth < cb.max_depth)
+		cb.max_depth = gs.suggested_depth;
+	if (0 < gs.suggested_size and gs.suggested_size < cb.max_network_size)
+		cb.max_network_size = gs.suggested_size;
+}
+
+// ========================== END OF FILE ==========================
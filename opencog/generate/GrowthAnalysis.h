@@ -0,0 +1,136 @@
+/*
+ * opencog/generate/GrowthAnalysis.h
+ *
+ * Copyright (C) 2020 Linas Vepstas <linasvepstas@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_GROWTH_ANALYSIS_H
+#define _OPENCOG_GROWTH_ANALYSIS_H
+
+#include <unordered_map>
+#include <vector>
+
+#include <opencog/generate/Dictionary.h>
+#include <opencog/generate/GenerateCallback.h>
+
+namespace opencog
+{
+/** \addtogroup grp_generate
+ *  @{
+ */
+
+/// What to expect of the networks grown at random from some roots.
+/// See `GrowthAnalysis`. The sizes count sections (points), as does
+/// `max_network_size`, and the depths count generations, as does
+/// `max_depth`.
+struct GrowthStats
+{
+	/// Spectral radius of the mean-offspring matrix: the factor by
+	/// which the number of open connectors grows, on average, with
+	/// each generation. At one or more, growth is supercritical, and
+	/// the expected size is infinite.
+	double spectral_radius = 0.0;
+
+	/// Probability that the network stops growing, by itself.
+	double extinction = 1.0;
+
+	/// Expected number of sections, its standard deviation, and the
+	/// expected depth. Infinite, if supercritical.
+	double mean_size = 0.0;
+	double size_deviation = 0.0;
+	double mean_depth = 0.0;
+
+	/// Bounds that cut off only a few of the networks that stop
+	/// growing by themselves. Zero, if there is no suggestion, e.g.
+	/// if (almost) none do.
+	size_t suggested_depth = 0;
+	size_t suggested_size = 0;
+
+	bool supercritical(void) const { return 1.0 <= spectral_radius; }
+	void print(void) const;
+};
+
+/// Predict, before running it, how large the networks drawn at random
+/// from a dictionary will grow, by treating the growth as a multi-type
+/// branching process. Each open connector is closed by drawing a new
+/// section holding one of its joints, as the `RandomCallback` does,
+/// with the weights at the weight key; the other connectors on that
+/// section are its offspring. The mean-offspring matrix, with a row
+/// and column for each connector, gives the rate of growth; its
+/// spectral radius decides if the network is finite, on average.
+///
+/// Connections made between connectors that are already open (loops)
+/// are not modelled; they can only make the networks smaller, and so
+/// the predictions are pessimistic for lexes with many loops. When a
+/// connector has several joints, each one is taken to be equally
+/// likely. A connector that no section can close is left open, and
+/// does not grow.
+class GrowthAnalysis
+{
+	const Dictionary& _dict;
+	Handle _weight_key;
+
+	/// A way of closing a connector: with probability `prob`, a
+	/// section is drawn, adding `count` open connectors of each of
+	/// the listed kinds.
+	struct Draw
+	{
+		double prob;
+		std::vector<std::pair<size_t, size_t>> offspring;
+	};
+
+	/// The connectors that can be reached from the roots, numbered,
+	/// and the ways of closing each of them.
+	HandleSeq _cons;
+	std::unordered_map<Handle, size_t> _con_ids;
+	std::vector<std::vector<Draw>> _draws;
+
+	/// The root sections, as draws.
+	std::vector<std::vector<Draw>> _roots;
+
+	size_t con_id(const Handle&);
+	std::vector<Draw> draws(const HandleSeq&, const Handle&);
+	void tabulate(const HandleSet&);
+
+	typedef std::vector<double> Vec;
+	Vec mean_offspring(const Vec&) const;
+	Vec solve(const Vec&) const;
+	double spectral_radius(void) const;
+
+public:
+	GrowthAnalysis(const Dictionary&, const Handle& weight_key);
+
+	/// The fraction of the finite networks that the suggested bounds
+	/// should allow. Defaults to 0.99.
+	double coverage = 0.99;
+
+	/// Cap on the iterations of the numerical methods.
+	size_t max_iterations = 10000;
+
+	GrowthStats analyze(const HandleSet& roots);
+
+	/// Lower the callback's `max_depth` and `max_network_size` to the
+	/// suggested bounds, if there are any.
+	static void apply(const GrowthStats&, GenerateCallback&);
+};
+
+
+/** @}*/
+}  // namespace opencog
+
+#endif // _OPENCOG_GROWTH_ANALYSIS_H
@@ -0,0 +1,90 @@
+/*
+ * opencog/generate/LexisSampler.cc
+ *
+ * Copyright (C) 2020 Linas Vepstas <linasvepstas@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <opencog/atoms/base/Atom.h>
+#include <opencog/atoms/value/FloatValue.h>
+
+#include "LexisSampler.h"
+
+using namespace opencog;
+
+LexisSampler::LexisSampler(const Handle& weight_key) :
+	_weight_key(weight_key)
+{
+}
+
+/// The chooser is handed out as a copy, so that it can be drawn from
+/// without holding the lock. Copying is cheap, compared to looking up
+/// all of the weights again.
+LexisSampler::Chooser LexisSampler::chooser(const Handle& key,
+                                            const HandleSeq& sects)
+{
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		auto it = _choosers.find(key);
+		if (_choosers.end() != it) return it->second;
+	}
+
+	// Make it without the lock; if another thread got there first,
+	// its chooser is the same as ours.
+	Chooser dist(make(_weight_key, sects));
+	std::lock_guard<std::mutex> lck(_mtx);
+	_choosers.emplace(key, dist);
+	return dist;
+}
+
+void LexisSampler::forget(const Handle& key)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	_choosers.erase(key);
+}
+
+void LexisSampler::clear(void)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	_choosers.clear();
+}
+
+size_t LexisSampler::size(void)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	return _choosers.size();
+}
+
+/// The pdf aka "probability distribution function" is just given by
+/// the weighting-key hanging off the section (in a FloatValue).
+LexisSampler::Chooser LexisSampler::make(const Handle& weight_key,
+                                         const HandleSeq& sects)
+{
+	std::vector<double> pdf;
+	pdf.reserve(sects.size());
+	for (const Handle& sect: sects)
+	{
+		FloatValuePtr fvp(FloatValueCast(sect->getValue(weight_key)));
+		if (fvp)
+			pdf.push_back(fvp->value()[0]);
+		else
+			pdf.push_back(0.0);
+	}
+	return Chooser(pdf.begin(), pdf.end());
+}
+
+// ========================== END OF FILE ==========================
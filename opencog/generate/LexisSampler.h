@@ -0,0 +1,83 @@
+/*
+ * opencog/generate/LexisSampler.h
+ *
+ * Copyright (C) 2020 Linas Vepstas <linasvepstas@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_LEXIS_SAMPLER_H
+#define _OPENCOG_LEXIS_SAMPLER_H
+
+#include <mutex>
+#include <random>
+#include <unordered_map>
+
+#include <opencog/atoms/base/Handle.h>
+
+namespace opencog
+{
+/** \addtogroup grp_generate
+ *  @{
+ */
+
+/// Weighted choosers over lists of sections of a dictionary, e.g. all
+/// of the sections holding some connector, or all of the sections of
+/// some point. The weight of a section is the first number of the
+/// FloatValue at the weight key; sections without one are never
+/// chosen. Building a chooser means looking up the weight of every
+/// section in the list, and so they are kept, under the connector or
+/// the point, until they are forgotten. A sampler can be shared by
+/// several callbacks, and used from several threads at once, as long
+/// as they all use the same dictionary, and the same weight key.
+class LexisSampler
+{
+public:
+	typedef std::discrete_distribution<size_t> Chooser;
+
+private:
+	Handle _weight_key;
+	std::mutex _mtx;
+	std::unordered_map<Handle, Chooser> _choosers;
+
+public:
+	LexisSampler(const Handle& weight_key);
+
+	const Handle& weight_key(void) const { return _weight_key; }
+
+	/// Return the chooser of an index into `sects`; it is made, and
+	/// kept under `key`, if there is none yet. The list of sections
+	/// under a given key must not change, until it is forgotten.
+	Chooser chooser(const Handle& key, const HandleSeq& sects);
+
+	/// Forget the chooser kept under `key`, if any.
+	void forget(const Handle& key);
+
+	/// Forget all of the choosers.
+	void clear(void);
+
+	size_t size(void);
+
+	/// Make a chooser of an index into `sects`, weighted by the values
+	/// at `weight_key`. Nothing is kept.
+	static Chooser make(const Handle& weight_key, const HandleSeq& sects);
+};
+
+
+/** @}*/
+}  // namespace opencog
+
+#endif // _OPENCOG_LEXIS_SAMPLER_H
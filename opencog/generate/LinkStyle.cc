@@ -19,6 +19,7 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <algorithm>
 #include <random>
 #include <uuid/uuid.h>
 
@@ -29,7 +30,8 @@
 
 using namespace opencog;
 
-LinkStyle::LinkStyle(void) : _scratch(nullptr)
+LinkStyle::LinkStyle(void) :
+	_scratch(nullptr), _seeded(false), _reclaim(true)
 {
 }
 
@@ -41,15 +43,35 @@ LinkStyle::LinkStyle(void) : _scratch(nullptr)
 /// This assumes that the section point is a node, so that we
 /// generate a unique string for that node.
 Handle LinkStyle::create_unique_section(const Handle& sect)
+{
+	Handle upoint(create_unique_point(sect->getOutgoingAtom(0)));
+	Handle disj = sect->getOutgoingAtom(1);
+
+	// Create a unique instance of the section.
+	Handle usect(_scratch->add_link(SECTION, upoint, disj));
+	if (_reclaim) _created.push_back(usect);
+
+	// Record it's original type.
+	// _inhsects.emplace_back(createLink(INHERITANCE_LINK, upoint, sect));
+
+	return usect;
+}
+
+/// Create a unique instance of the point, by appending a UUID to
+/// its name. The point must be a node.
+Handle LinkStyle::create_unique_point(const Handle& point)
 {
 	uuid_t uu;
-	uuid_generate(uu);
+	if (_seeded)
+	{
+		for (size_t i = 0; i < sizeof(uu); i++)
+			uu[i] = _namegen();
+	}
+	else
+		uuid_generate(uu);
 	char idstr[37];
 	uuid_unparse(uu, idstr);
 
-	Handle point = sect->getOutgoingAtom(0);
-	Handle disj = sect->getOutgoingAtom(1);
-
 	if (not point->is_node())
 		throw RuntimeException(TRACE_INFO,
 			"Expection a Node for the section point, got %s",
@@ -58,18 +80,13 @@ Handle LinkStyle::create_unique_section(const Handle& sect)
 	// Create a unique point.
 	Handle upoint(_scratch->add_node(point->get_type(),
 	              point->get_name() + "@" + idstr));
+	if (_reclaim) _created.push_back(upoint);
 
 	// Record the point location.
 	if (_point_set)
 		_mempoints.emplace_back(createLink(MEMBER_LINK, upoint, _point_set));
 
-	// Create a unique instance of the section.
-	Handle usect(_scratch->add_link(SECTION, upoint, disj));
-
-	// Record it's original type.
-	// _inhsects.emplace_back(createLink(INHERITANCE_LINK, upoint, sect));
-
-	return usect;
+	return upoint;
 }
 
 /// Create an undirected edge connecting the two points `fm_pnt` and
@@ -86,6 +103,11 @@ Handle LinkStyle::create_undirected_link(const Handle& fm_con,
 	Handle linkty = fm_con->getOutgoingAtom(0);
 	Handle edg = _scratch->add_link(SET_LINK, fm_pnt, to_pnt);
 	Handle lnk = _scratch->add_link(EVALUATION_LINK, linkty, edg);
+	if (_reclaim)
+	{
+		_created.push_back(edg);
+		_created.push_back(lnk);
+	}
 	return lnk;
 }
 
@@ -160,6 +182,67 @@ void LinkStyle::clear(void)
 {
 	_mempoints.clear();
 	_inhsects.clear();
+	_seeded = false;
+	_reclaim = true;
+	_created.clear();
+	while (not _created_marks.empty()) _created_marks.pop();
+}
+
+/// Don't remove anything from the scratch space when frames are
+/// popped, until the next `clear()`; for aggregators whose frames
+/// outlive their pop.
+void LinkStyle::keep_scratch(void)
+{
+	_reclaim = false;
+	_created.clear();
+	while (not _created_marks.empty()) _created_marks.pop();
+}
+
+/// Remember what has been created so far; to be called when the
+/// aggregator pushes a frame.
+void LinkStyle::push_scratch(void)
+{
+	if (not _reclaim) return;
+	_created_marks.push({_created.size(), _mempoints.size()});
+}
+
+/// Remove the atoms created since the matching `push_scratch()` from
+/// the scratch space, newest first. Removal fails for those that are
+/// still in use (that have a non-empty incoming set), and so only the
+/// points and links of abandoned attachments go away. This assumes
+/// that the aggregator has already removed its own sections for the
+/// frame. Removed points are forgotten by `save_work()`, too.
+void LinkStyle::pop_scratch(void)
+{
+	if (_created_marks.empty()) return;
+	std::pair<size_t, size_t> mark = _created_marks.top();
+	_created_marks.pop();
+
+	HandleSet gone;
+	while (mark.first < _created.size())
+	{
+		const Handle& h = _created.back();
+		if (_scratch->remove_atom(h) and h->is_node())
+			gone.insert(h);
+		_created.pop_back();
+	}
+
+	if (gone.empty()) return;
+	auto kept = std::remove_if(_mempoints.begin() + mark.second,
+		_mempoints.end(), [&](const Handle& mem)
+			{ return 0 < gone.count(mem->getOutgoingAtom(0)); });
+	_mempoints.erase(kept, _mempoints.end());
+}
+
+/// Draw the unique point names from a generator seeded with `s`.
+/// Two runs with the same seed then name their points the same way;
+/// the names no longer differ from one run to the next, and so the
+/// order in which atoms are stored, which depends on their names,
+/// does not either. Lasts until the next `clear()`.
+void LinkStyle::seed(unsigned long s)
+{
+	_namegen.seed(s);
+	_seeded = true;
 }
 
 void LinkStyle::save_work(AtomSpace* as)
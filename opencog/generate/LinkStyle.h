@@ -22,6 +22,9 @@
 #ifndef _OPENCOG_LINK_STYLE_H
 #define _OPENCOG_LINK_STYLE_H
 
+#include <random>
+#include <stack>
+
 #include <opencog/atomspace/AtomSpace.h>
 
 namespace opencog
@@ -42,11 +45,30 @@ protected:
 	HandleSeq _mempoints;
 	HandleSeq _inhsects;
 
+	/// If seeded, the unique point names are drawn from this, instead
+	/// of being fresh UUIDs, so that runs can be repeated.
+	std::mt19937_64 _namegen;
+	bool _seeded;
+
+	/// Atoms created in the scratch space, in the order of creation,
+	/// and, for each pushed frame, how many of them (and how many
+	/// `_mempoints`) there were at the push. Not kept when the frames
+	/// outlive their pop; see `keep_scratch()`.
+	bool _reclaim;
+	HandleSeq _created;
+	std::stack<std::pair<size_t, size_t>> _created_marks;
+
 public:
 	LinkStyle(void);
 	void clear(void);
+	void seed(unsigned long);
+
+	void keep_scratch(void);
+	void push_scratch(void);
+	void pop_scratch(void);
 
 	Handle create_unique_section(const Handle&);
+	Handle create_unique_point(const Handle&);
 	Handle create_undirected_link(const Handle&, const Handle&,
 	                              const Handle&, const Handle&);
 
@@ -41,6 +41,15 @@ void Odometer::clear(void)
 	_sections.clear();
 	_from_index.clear();
 	_to_connectors.clear();
+	_point_wheels.clear();
+	_picks.clear();
+	_con_runs.clear();
+	_sect_runs.clear();
+	_explored.clear();
+	_twinned = false;
+	_memo_key.clear();
+	_memo_solved = 0;
+	_memo_spawned = 0;
 	_size = 0;
 	_step = -1;
 	_frame_depth = 0;
@@ -22,6 +22,11 @@
 #ifndef _OPENCOG_ODOMETER_H
 #define _OPENCOG_ODOMETER_H
 
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
 #include <opencog/atomspace/AtomSpace.h>
 
 namespace opencog
@@ -74,6 +79,58 @@ struct Odometer
 	/// may be multiple to-connectors for each from-connector.
 	HandleSeq _to_connectors;
 
+	/// Index from each point to the wheels whose from-sections hold
+	/// that point. Connecting up a section changes the section, but
+	/// not its point, and so this index does not change during the
+	/// lifetime of the odometer. Used to find the wheels that need
+	/// updating, when a section is connected.
+	std::map<Handle, std::vector<size_t>> _point_wheels;
+
+	/// Symmetry breaking; used only if `break_symmetry` is set.
+	/// What each wheel attached to, on the most recent step: nothing
+	/// (its connector was already connected), a section that was
+	/// already open, or a new section drawn from the lexis. New
+	/// sections are identified by their point (less the uuid) and
+	/// their connector sequence; that is, by the lexis entry they
+	/// were drawn from.
+	enum PickKind { SKIPPED, OPENED, DRAWN };
+	struct Pick
+	{
+		PickKind _kind = SKIPPED;
+		Handle _point;
+		std::string _name;
+		Handle _disj;
+	};
+	std::vector<Pick> _picks;
+
+	/// The wheels, grouped into runs: one run of wheels for each open
+	/// connector, and one run of connectors for each open section.
+	/// Runs in the same class are interchangeable: identical connectors
+	/// on the same section, or twin sections (same point, same
+	/// connectors, linked to the same neighbors).
+	struct Run
+	{
+		size_t _begin;
+		size_t _end;
+		size_t _class;
+	};
+	std::vector<Run> _con_runs;
+	std::vector<Run> _sect_runs;
+
+	/// True if any two runs are in the same class; if not, there
+	/// is no symmetry to break.
+	bool _twinned;
+
+	/// The odometer states explored so far, up to symmetry.
+	std::set<std::string> _explored;
+
+	/// Dead-state memo: the key of the frame that this odometer was
+	/// set up for, and the number of solutions reached and subtrees
+	/// handed off, at the time. Empty, if not memoized.
+	std::string _memo_key;
+	size_t _memo_solved;
+	size_t _memo_spawned;
+
 	/// The next wheel to be stepped. This is an index into the
 	/// above sequences.
 	size_t _step;
@@ -0,0 +1,385 @@
+/*
+ * opencog/generate/ParallelAggregate.cc
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <exception>
+#include <functional>
+#include <thread>
+
+#include <opencog/util/Logger.h>
+#include <opencog/atoms/base/Link.h>
+
+#include "Aggregate.h"
+#include "Canonical.h"
+#include "ParallelAggregate.h"
+
+using namespace opencog;
+
+namespace opencog
+{
+
+/// Wrapper around a worker's callback. Everything is passed through
+/// to the wrapped callback, except that the step and solution counts
+/// are also tallied against the budget shared by all workers.
+class SharedBudget : public GenerateCallback
+{
+private:
+	ParallelAggregate* _pa;
+	GenerateCallback* _cb;
+
+	bool exhausted(void) {
+		return _pa->_max_steps < _pa->_steps_taken or
+			_pa->_max_solutions <= _pa->_num_solutions;
+	}
+
+public:
+	SharedBudget(ParallelAggregate* pa, GenerateCallback* cb) :
+		GenerateCallback(pa->_as), _pa(pa), _cb(cb)
+	{
+		// The aggregator reads the generic parameters directly,
+		// and so these must be the same as those of the wrapped
+		// callback.
+		GenerateCallback::operator=(*cb);
+	}
+
+	virtual void clear(AtomSpace* scratch) { _cb->clear(scratch); }
+	virtual void root_set(const HandleSet& pts) { _cb->root_set(pts); }
+
+	virtual HandleSet next_root(void) {
+		if (exhausted()) return HandleSet();
+		return _cb->next_root();
+	}
+
+	virtual const HandleSeq& joints(const Handle& con) {
+		return _cb->joints(con);
+	}
+	virtual Handle select(const OdoFrame& frm,
+	                      const Handle& fm_sect, size_t offset,
+	                      const Handle& to_con) {
+		return _cb->select(frm, fm_sect, offset, to_con);
+	}
+	virtual Handle make_link(const Handle& fm_con, const Handle& to_con,
+	                         const Handle& fm_pnt, const Handle& to_pnt) {
+		return _cb->make_link(fm_con, to_con, fm_pnt, to_pnt);
+	}
+	virtual size_t num_links(const Handle& fm_sect, const Handle& to_sect,
+	                         const Handle& link_type) {
+		return _cb->num_links(fm_sect, to_sect, link_type);
+	}
+
+	virtual void push_frame(const OdoFrame& frm) { _cb->push_frame(frm); }
+	virtual void pop_frame(const OdoFrame& frm) { _cb->pop_frame(frm); }
+	virtual void keep_scratch(void) { _cb->keep_scratch(); }
+	virtual void push_odometer(const Odometer& odo) { _cb->push_odometer(odo); }
+	virtual void pop_odometer(const Odometer& odo) { _cb->pop_odometer(odo); }
+
+	virtual bool step(const OdoFrame& frm) {
+		_pa->_steps_taken ++;
+		if (not _cb->step(frm)) return false;
+		return not exhausted();
+	}
+	virtual bool viable(const OdoFrame& frm) { return _cb->viable(frm); }
+	virtual size_t num_choices(const OdoFrame& frm, const Handle& to_con) {
+		return _cb->num_choices(frm, to_con);
+	}
+	virtual double fitness(const OdoFrame& frm) { return _cb->fitness(frm); }
+
+	virtual void solution(const OdoFrame& frm) {
+		size_t before = _cb->num_solutions();
+		_cb->solution(frm);
+		if (before != _cb->num_solutions())
+			_pa->record_solution(frm._linkage);
+	}
+
+	virtual Handle get_solutions(void) { return _cb->get_solutions(); }
+	virtual size_t num_solutions(void) { return _cb->num_solutions(); }
+	virtual size_t num_steps(void) { return _cb->num_steps(); }
+};
+
+} // namespace opencog
+
+ParallelAggregate::ParallelAggregate(AtomSpace* as)
+	: _as(as), _max_steps(0), _max_solutions(0),
+	_steps_taken(0), _num_solutions(0), _isomorphic(false),
+	_busy(0), _idle(0), _queued(0)
+{
+}
+
+ParallelAggregate::~ParallelAggregate()
+{
+}
+
+/// Run one worker. Each worker gets its own aggregator, and thus its
+/// own scratch space and traversal state.
+void ParallelAggregate::worker(const HandleSet& nuclei,
+                               GenerateCallback* cb)
+{
+	SharedBudget budget(this, cb);
+	Aggregate ag(_as);
+	ag.aggregate(nuclei, budget);
+
+	std::lock_guard<std::mutex> lck(_mtx);
+	_stats.merge(ag.stats());
+	_scratches.push_back(ag._scratch);
+}
+
+/// Set up the shared budget, from the limits on the first callback.
+void ParallelAggregate::init(const std::vector<GenerateCallback*>& cbs)
+{
+	_cbs = cbs;
+	_max_steps = _cbs[0]->max_steps;
+	_max_solutions = _cbs[0]->max_solutions;
+	_stats = AggregateStats();
+	_steps_taken = 0;
+	_num_solutions = 0;
+	_solutions.clear();
+	_isomorphic = _cbs[0]->dedup_isomorphic;
+	_shapes.clear();
+	_scratches.clear();
+}
+
+/// Record a solution found by one of the threads, unless some thread
+/// found it (or, if `_isomorphic`, one of the same shape) before, or
+/// enough have been found already. Several threads may find the same
+/// solution; only the first counts.
+void ParallelAggregate::record_solution(const HandleSet& linkage)
+{
+	std::string shape;
+	if (_isomorphic) shape = Canonical::form(linkage);
+
+	std::lock_guard<std::mutex> lck(_soln_mtx);
+	if (_max_solutions <= _solutions.size()) return;
+	if (_isomorphic and not _shapes.insert(shape).second) return;
+	if (_solutions.insert(linkage).second) _num_solutions ++;
+}
+
+/// Each thread counted the solutions that were new to it; several
+/// threads may have found the same one, and those found after the
+/// limit was reached were not kept. Only those kept are solutions;
+/// the rest are rediscoveries.
+void ParallelAggregate::tally(void)
+{
+	size_t kept = _num_solutions;
+	if (kept < _stats.solutions)
+		_stats.rediscoveries += _stats.solutions - kept;
+	_stats.solutions = kept;
+}
+
+/// Run `fn(i)` on one thread per callback. Returns after all of the
+/// threads have finished. If any of them threw, then the first such
+/// exception is re-thrown here.
+void ParallelAggregate::run(const std::function<void(size_t)>& fn)
+{
+	logger().fine("Parallel aggregate on %lu threads", _cbs.size());
+
+	std::vector<std::exception_ptr> errs(_cbs.size());
+	std::vector<std::thread> pool;
+	for (size_t i = 0; i < _cbs.size(); i++)
+	{
+		pool.emplace_back([&fn, &errs, i]()
+		{
+			try { fn(i); }
+			catch (...) { errs[i] = std::current_exception(); }
+		});
+	}
+	for (std::thread& thr : pool) thr.join();
+
+	for (const std::exception_ptr& ep : errs)
+		if (ep) std::rethrow_exception(ep);
+}
+
+/// Aggregate, using one thread per callback, each thread drawing
+/// its own roots.
+void ParallelAggregate::aggregate(const HandleSet& nuclei,
+                                  const std::vector<GenerateCallback*>& cbs)
+{
+	if (0 == cbs.size()) return;
+	init(cbs);
+	run([this, &nuclei](size_t i) { worker(nuclei, _cbs[i]); });
+	tally();
+}
+
+// ----------------------------------------------------------------
+
+/// Exhaustively enumerate, using one thread per callback. The roots
+/// are drawn from the first callback, up front; the subtrees hanging
+/// off of them are then explored by whichever thread gets to them.
+void ParallelAggregate::enumerate(const HandleSet& nuclei,
+                                  const std::vector<GenerateCallback*>& cbs)
+{
+	if (0 == cbs.size()) return;
+	init(cbs);
+
+	// All threads share one scratch space.
+	AtomSpacePtr scratch = createAtomSpace(_as);
+	_scratches.push_back(scratch);
+	for (GenerateCallback* cb : _cbs)
+		cb->clear(scratch.get());
+
+	_queues.clear();
+	_queues.resize(_cbs.size());
+	_busy = 0;
+	_idle = 0;
+	_queued = 0;
+
+	// Every callback is told of the roots, not just the first: the
+	// pruned lexis depends on them, and the threads must all agree
+	// on what is viable.
+	for (GenerateCallback* cb : _cbs)
+		cb->root_set(nuclei);
+	while (true)
+	{
+		HandleSet starters = _cbs[0]->next_root();
+		if (starters.size() == 0) break;
+
+		Task task;
+		task.frame.clear();
+		task.frame._open_sections = starters;
+		task.frame._nodo = 0;
+		task.depth = 0;
+		_queues[0].emplace_back(std::move(task));
+		_queued ++;
+	}
+
+	run([this, scratch](size_t i) { enumerator(i, scratch, _cbs[i]); });
+	_stats.scratch_atoms = scratch->get_size();
+	tally();
+}
+
+/// Get the next subtree to explore. Returns false when there is
+/// nothing left to do: no work is queued, and no thread is busy
+/// (and so no more work can appear).
+bool ParallelAggregate::next_task(size_t id, Task& task)
+{
+	std::unique_lock<std::mutex> lck(_mtx);
+	while (true)
+	{
+		// Our own work first, most recent first.
+		if (not _queues[id].empty())
+		{
+			task = std::move(_queues[id].back());
+			_queues[id].pop_back();
+			break;
+		}
+
+		// Steal the oldest work from someone else.
+		bool found = false;
+		for (size_t j = 1; j < _queues.size(); j++)
+		{
+			std::deque<Task>& q = _queues[(id + j) % _queues.size()];
+			if (q.empty()) continue;
+			task = std::move(q.front());
+			q.pop_front();
+			found = true;
+			break;
+		}
+		if (found) break;
+
+		if (0 == _busy)
+		{
+			_cv.notify_all();
+			return false;
+		}
+
+		_idle ++;
+		_cv.wait(lck);
+		_idle --;
+	}
+	_queued --;
+	_busy ++;
+	return true;
+}
+
+/// Offer a subtree to the idle threads. Called by the aggregator
+/// running in thread `id`, instead of exploring it itself.
+void ParallelAggregate::spawn(size_t id, const OdoFrame& frame,
+                              size_t depth)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	_queues[id].push_back({frame, depth});
+	_queued ++;
+	_cv.notify_one();
+}
+
+/// Run one enumerating thread. This explores subtrees until there
+/// are none left.
+void ParallelAggregate::enumerator(size_t id, AtomSpacePtr scratch,
+                                   GenerateCallback* cb)
+{
+	SharedBudget budget(this, cb);
+	Aggregate ag(_as);
+	ag._cb = &budget;
+	ag._scratch = scratch;
+	ag._pool = this;
+	ag._pool_id = id;
+
+	// Frames are handed to other threads; whatever they hold must
+	// stay in the scratch space.
+	ag._reclaim = false;
+	budget.keep_scratch();
+	ag._memo.reset(cb->memo_size);
+	ag._deadline.start(budget);
+	ag._stats.start();
+
+	Task task;
+	while (next_task(id, task))
+	{
+		// Same as what `Aggregate::aggregate()` does for a root,
+		// except that the frame is the one that was handed over.
+		try
+		{
+			ag._odo_base = task.depth;
+			ag._frame = std::move(task.frame);
+			ag.push_frame();
+			ag.recurse();
+			ag.pop_frame();
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lck(_mtx);
+			_busy --;
+			_cv.notify_all();
+			throw;
+		}
+
+		std::lock_guard<std::mutex> lck(_mtx);
+		_busy --;
+		if (0 == _busy) _cv.notify_all();
+	}
+
+	ag._stats.stop();
+	std::lock_guard<std::mutex> lck(_mtx);
+	_stats.merge(ag._stats);
+}
+
+/// Return a SetLink holding the solutions found by all of the
+/// threads. The duplicates, including those found by different
+/// threads, were dropped as they were found.
+Handle ParallelAggregate::get_solutions(void)
+{
+	std::lock_guard<std::mutex> lck(_soln_mtx);
+	HandleSeq solns;
+	for (const HandleSet& sol : _solutions)
+	{
+		HandleSeq sects(sol.begin(), sol.end());
+		solns.push_back(createLink(std::move(sects), SET_LINK));
+	}
+	return createLink(std::move(solns), SET_LINK);
+}
+
+// ========================== END OF FILE ==========================
@@ -0,0 +1,150 @@
+/*
+ * opencog/generate/ParallelAggregate.h
+ *
+ * Copyright (C) 2020 Linas Vepstas <linasvepstas@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_PARALLEL_AGGREGATE_H
+#define _OPENCOG_PARALLEL_AGGREGATE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/generate/AggregateStats.h>
+#include <opencog/generate/GenerateCallback.h>
+#include <opencog/generate/Odometer.h>
+
+namespace opencog
+{
+/** \addtogroup grp_generate
+ *  @{
+ */
+
+/// Multi-start aggregation, run on a pool of threads. Each thread
+/// runs its own `Aggregate` (and thus has its own scratch AtomSpace,
+/// odometer and frame stacks) with its own callback. The threads pull
+/// root draws (via `GenerateCallback::next_root()`) until the shared
+/// step and solution budgets are used up. The budgets are taken from
+/// the `max_steps` and `max_solutions` of the first callback.
+///
+/// This is useful only for callbacks where each draw of roots is
+/// independent of the others, e.g. the `RandomCallback`. Callbacks
+/// that enumerate all possibilities, e.g. the `SimpleCallback`, would
+/// just do the same work N times over; use `enumerate()` for those.
+///
+/// The `enumerate()` method splits the search tree into
+/// subtrees, which are handed to idle threads. Each subtree is rooted
+/// at a frame: exploring it (via `Aggregate::recurse()`) depends only
+/// on the contents of that frame, and not on any callback state, which
+/// always starts out fresh at each new odometer and frame. The threads
+/// share a single scratch AtomSpace, so that the subtrees can share
+/// the atoms that were created before the split. The set of solutions
+/// is the same as that found by `Aggregate::aggregate()`, provided
+/// that the step and solution limits are not hit.
+///
+/// The callbacks must not share any mutable state with one-another.
+class ParallelAggregate
+{
+private:
+	AtomSpace* _as;
+	std::vector<GenerateCallback*> _cbs;
+
+	/// Shared budget.
+	size_t _max_steps;
+	size_t _max_solutions;
+	std::atomic<size_t> _steps_taken;
+	std::atomic<size_t> _num_solutions;
+
+	/// The statistics of all of the threads, added up; except that
+	/// the solutions are those in `_solutions`. See `tally()`.
+	AggregateStats _stats;
+	void tally(void);
+
+	/// The solutions found by all of the threads, less the duplicates;
+	/// only these count against `_max_solutions`. If `_isomorphic`,
+	/// then the duplicates include the networks of the same shape.
+	std::mutex _soln_mtx;
+	std::set<HandleSet> _solutions;
+	bool _isomorphic;
+	std::unordered_set<std::string> _shapes;
+
+	/// The scratch spaces of the threads. The solutions are made of
+	/// atoms held in these, and so they are kept until the next run.
+	std::vector<AtomSpacePtr> _scratches;
+
+	friend class SharedBudget;
+	void init(const std::vector<GenerateCallback*>&);
+	void record_solution(const HandleSet&);
+	void run(const std::function<void(size_t)>&);
+	void worker(const HandleSet&, GenerateCallback*);
+
+	/// A subtree to be explored: the frame at its root, and the depth
+	/// of the odometer stack, at that frame.
+	struct Task
+	{
+		OdoFrame frame;
+		size_t depth;
+	};
+
+	/// One queue per thread. Threads push and pop their own queue
+	/// at the back; idle threads steal from the front of other queues,
+	/// so as to get the biggest (shallowest) subtrees.
+	std::vector<std::deque<Task>> _queues;
+	std::mutex _mtx;
+	std::condition_variable _cv;
+	size_t _busy;
+	std::atomic<size_t> _idle;
+	std::atomic<size_t> _queued;
+
+	bool next_task(size_t, Task&);
+	void enumerator(size_t, AtomSpacePtr, GenerateCallback*);
+
+	friend class Aggregate;
+	bool want_work(void) { return _queued < _idle; }
+	void spawn(size_t, const OdoFrame&, size_t);
+
+public:
+	ParallelAggregate(AtomSpace*);
+	~ParallelAggregate();
+
+	void aggregate(const HandleSet&, const std::vector<GenerateCallback*>&);
+	void enumerate(const HandleSet&, const std::vector<GenerateCallback*>&);
+
+	/// The solutions found by all of the threads. They remain valid
+	/// until the next run, or until this is destroyed.
+	Handle get_solutions(void);
+
+	/// Search statistics, added up over all of the threads. The
+	/// solutions are counted once, no matter how many threads found
+	/// them; the other finds are counted as rediscoveries.
+	const AggregateStats& stats(void) const { return _stats; }
+};
+
+
+/** @}*/
+}  // namespace opencog
+
+#endif // _OPENCOG_PARALLEL_AGGREGATE_H
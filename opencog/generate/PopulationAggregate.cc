@@ -0,0 +1,166 @@
+/*
+ * opencog/generate/PopulationAggregate.cc
+ *
+ * Copyright (C) 2020 Linas Vepstas <linasvepstas@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <opencog/util/Logger.h>
+#include <opencog/atoms/base/Link.h>
+
+#include "PopulationAggregate.h"
+
+using namespace opencog;
+
+PopulationAggregate::PopulationAggregate(AtomSpace* as)
+	: _as(as), _cb(nullptr), _ag(as), _rounds(0)
+{
+	std::random_device seed;
+	_rangen.seed(seed());
+}
+
+PopulationAggregate::~PopulationAggregate()
+{
+}
+
+/// The weight of a member: the callback's opinion of it, times how
+/// close it is to being finished.
+double PopulationAggregate::weight(const OdoFrame& frm)
+{
+	size_t nopen = 0;
+	for (const Handle& sect : frm._open_sections)
+		for (const Handle& con : sect->getOutgoingAtom(1)->getOutgoingSet())
+			if (CONNECTOR == con->get_type()) nopen ++;
+
+	return _cb->fitness(frm) / (1.0 + nopen);
+}
+
+/// Grow the `parent` by one layer. Return true, and the grown member
+/// in `child`, if it is still unfinished. If it was finished, it was
+/// reported to the callback as a solution.
+bool PopulationAggregate::grow(const Member& parent, Member& child)
+{
+	// Same as what `ParallelAggregate::enumerator()` does with a task,
+	// except that only the first step of the odometer is taken.
+	_ag._odo_base = parent._depth;
+	_ag._frame = parent._frame;
+	_ag.push_frame();
+
+	bool grown = false;
+	if (_ag.enter())
+	{
+		if (not _ag._redundant and 0 < _ag._frame._open_sections.size() and
+		    _cb->viable(_ag._frame))
+		{
+			child._frame = _ag._frame;
+			child._depth = _ag.odo_depth();
+			child._weight = weight(child._frame);
+			grown = 0.0 < child._weight;
+		}
+		_ag.pop_odo();
+	}
+	_ag.pop_frame();
+	_ag._found = false;
+	return grown;
+}
+
+/// One round: draw `popsize` members, by weight, and grow each of
+/// them. The members that were grown are the next population.
+void PopulationAggregate::round(size_t popsize)
+{
+	std::vector<double> pdf;
+	for (const Member& mbr : _population)
+		pdf.push_back(mbr._weight);
+	std::discrete_distribution<size_t> dist(pdf.begin(), pdf.end());
+
+	std::vector<Member> next;
+	for (size_t i = 0; i < popsize; i++)
+	{
+		Member child;
+		if (grow(_population[dist(_rangen)], child))
+			next.emplace_back(std::move(child));
+	}
+	_population.swap(next);
+	_rounds ++;
+
+	logger().fine("Population round %lu: %lu alive, %lu solutions",
+		_rounds, _population.size(), _cb->num_solutions());
+}
+
+/// Top up the population with fresh root draws, until it is back to
+/// `popsize` members, or the callback runs out of roots. With random
+/// draws, the callback runs out only when its limits are reached.
+void PopulationAggregate::replenish(size_t popsize)
+{
+	while (_population.size() < popsize and not _ag._deadline.expired())
+	{
+		HandleSet starters = _cb->next_root();
+		if (starters.size() == 0) break;
+
+		Member mbr;
+		mbr._frame.clear();
+		mbr._frame._open_sections = starters;
+		mbr._frame._nodo = 0;
+		mbr._depth = 0;
+		mbr._weight = weight(mbr._frame);
+		if (0.0 == mbr._weight) break;
+		_population.emplace_back(std::move(mbr));
+	}
+}
+
+void PopulationAggregate::aggregate(const HandleSet& nuclei,
+                                    GenerateCallback& cb)
+{
+	_cb = &cb;
+	_ag._cb = &cb;
+	_ag.clear();
+
+	// Nothing is ever explored below a member, and so the members
+	// cannot be known to be dead.
+	_ag._memo.reset(0);
+
+	// The members keep the sections of popped frames.
+	_ag._reclaim = false;
+	cb.keep_scratch();
+
+	_population.clear();
+	_rounds = 0;
+
+	// As in `CompactAggregate::clear()`, with a tag of our own.
+	if (cb.random_seed)
+	{
+		std::seed_seq seq({cb.random_seed, 2UL});
+		_rangen.seed(seq);
+	}
+	size_t popsize = (0 < cb.population_size) ? cb.population_size : 1;
+
+	cb.root_set(nuclei);
+	replenish(popsize);
+	while (0 < _population.size())
+	{
+		round(popsize);
+		replenish(popsize);
+	}
+
+	_ag._stats.scratch_atoms = _ag._scratch->get_size();
+	_ag._stats.stop();
+	_ag._stats.print();
+	logger().debug("Population search: %lu rounds, %lu solutions",
+		_rounds, cb.num_solutions());
+}
+
+// ========================== END OF FILE ==========================
@@ -0,0 +1,112 @@
+/*
+ * opencog/generate/PopulationAggregate.h
+ *
+ * Copyright (C) 2020 Linas Vepstas <linasvepstas@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_POPULATION_AGGREGATE_H
+#define _OPENCOG_POPULATION_AGGREGATE_H
+
+#include <random>
+#include <vector>
+
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/generate/Aggregate.h>
+#include <opencog/generate/GenerateCallback.h>
+#include <opencog/generate/Odometer.h>
+
+namespace opencog
+{
+/** \addtogroup grp_generate
+ *  @{
+ */
+
+/// Population (beam) sampling. The `Aggregate` grows one assembly at
+/// a time, and backtracks when it cannot be finished; the sections
+/// nearest the root are then the last to change, and a bad early draw
+/// can stall the whole search. Here, instead, a population of up to
+/// `population_size` partial assemblies is kept. Each round, members
+/// are drawn from it, in proportion to their weight, and each one
+/// drawn is grown by one breadth-first layer: a brand-new odometer is
+/// set up on its open connectors, and stepped once, exactly as
+/// `Aggregate::enter()` does. The results are the next population.
+///
+/// Finished assemblies are reported to the callback as solutions, and
+/// leave the population. Assemblies that cannot be grown (the callback
+/// says they are not viable, or some connector has no mate) die out.
+/// The places they leave are filled with fresh draws of the roots.
+/// The weight of a member is its `GenerateCallback::fitness()`, times
+/// its closability, taken to be one over one plus the number of its
+/// open connectors. The search ends when the callback stops it, via
+/// `step()` and `next_root()`, e.g. because `max_steps` or
+/// `max_solutions` was reached, or runs out of roots, or when
+/// `max_time` runs out.
+///
+/// There is no backtracking, and no memory of the past, other than
+/// the members themselves; thus, the number of frames held is bounded
+/// by `population_size`. The members are independent of one another,
+/// and so they could be grown in parallel; this is not yet done.
+///
+/// This is meant for random generation, with the `RandomCallback`.
+/// The `SimpleCallback` grows the same member in the same way, each
+/// time it is drawn, and so finds only a handful of networks.
+class PopulationAggregate
+{
+private:
+	AtomSpace* _as;
+	GenerateCallback* _cb;
+
+	/// Used to grow each member, one layer at a time.
+	Aggregate _ag;
+	std::mt19937 _rangen;
+
+	/// A member: the frame holding the partial assembly, the depth of
+	/// the odometer stack at that frame, and the weight of the member.
+	struct Member
+	{
+		OdoFrame _frame;
+		size_t _depth;
+		double _weight;
+	};
+	std::vector<Member> _population;
+	size_t _rounds;
+
+	double weight(const OdoFrame&);
+	bool grow(const Member&, Member&);
+	void round(size_t);
+	void replenish(size_t);
+
+public:
+	PopulationAggregate(AtomSpace*);
+	~PopulationAggregate();
+
+	void aggregate(const HandleSet&, GenerateCallback&);
+
+	/// The number of rounds taken, and the number of members alive.
+	size_t num_rounds(void) const { return _rounds; }
+	size_t size(void) const { return _population.size(); }
+
+	/// Search statistics, over all of the rounds.
+	const AggregateStats& stats(void) const { return _ag.stats(); }
+};
+
+
+/** @}*/
+}  // namespace opencog
+
+#endif // _OPENCOG_POPULATION_AGGREGATE_H
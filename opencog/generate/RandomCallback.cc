@@ -30,10 +30,16 @@ using namespace opencog;
 
 RandomCallback::RandomCallback(AtomSpace* as, const Dictionary& dict,
                                RandomParameters& parms) :
-	GenerateCallback(as), _dict(dict), _parms(&parms)
+	GenerateCallback(as), _dict(dict), _viable(as), _parms(&parms)
 {
+	_pruned = false;
 	_steps_taken = 0;
 
+	// Each callback gets its own generator, so that several of them
+	// can be run concurrently, in different threads.
+	std::random_device seed;
+	_rangen.seed(seed());
+
 	max_solutions = 100;
 
 	// Not interested in networks larger than 20 nodes.
@@ -45,9 +51,6 @@ RandomCallback::RandomCallback(AtomSpace* as, const Dictionary& dict,
 
 RandomCallback::~RandomCallback() {}
 
-static std::random_device seed;
-static std::mt19937 rangen(seed());
-
 void RandomCallback::clear(AtomSpace* scratch)
 {
 	while (not _opensel_stack.empty()) _opensel_stack.pop();
@@ -58,42 +61,67 @@ void RandomCallback::clear(AtomSpace* scratch)
 	_root_dist.clear();
 	_distmap.clear();
 	_steps_taken = 0;
+
 	CollectStyle::clear();
 	LinkStyle::clear();
 	LinkStyle::_point_set = point_set;
+	CollectStyle::_isomorphic = dedup_isomorphic;
 	LinkStyle::_scratch = scratch;
+
+	// Repeatable runs. The parameters and the point names get seeds
+	// of their own, drawn from ours, so that the streams differ.
+	if (random_seed)
+	{
+		_rangen.seed(random_seed);
+		_parms->seed(_rangen());
+		LinkStyle::seed(_rangen());
+	}
 }
 
 void RandomCallback::root_set(const HandleSet& roots)
 {
+	_pruned = prune_lexis;
+	if (_pruned)
+	{
+		_viable = _dict;
+		_viable.prune(roots);
+	}
+
 	for (const Handle& point: roots)
 	{
-		HandleSeq sects(_dict.entries(point));
-		if (0 == sects.size())
+		if (0 == _dict.entries(point).size())
 			throw RuntimeException(TRACE_INFO,
 				"No dictionary entry for root=%s", point->to_string().c_str());
 
+		// Everything was pruned away; there are no solutions.
+		HandleSeq sects(dict().entries(point));
+		if (0 == sects.size())
+		{
+			_root_sections.clear();
+			_root_dist.clear();
+			return;
+		}
+
 		_root_sections.push_back(sects);
 
 		// Create a discrete distribution. This will randomly pick
 		// an index into the `root_sections` array. The weight of
-		// each index is given by the pdf aka "probability distribution
-		// function".  The pdf is just given by the weighting-key
-		// hanging off the section (in a FloatValue).
-		std::vector<double> pdf;
-		for (const Handle& sect: sects)
-		{
-			FloatValuePtr fvp(FloatValueCast(sect->getValue(_weight_key)));
-			if (fvp)
-				pdf.push_back(fvp->value()[0]);
-			else
-				pdf.push_back(0.0);
-		}
-		std::discrete_distribution<size_t> dist(pdf.begin(), pdf.end());
-		_root_dist.push_back(dist);
+		// each index is given by the weighting-key hanging off the
+		// section (in a FloatValue).
+		_root_dist.push_back(chooser(point, sects));
 	}
 }
 
+/// A chooser of an index into `sects`, the sections under `key`;
+/// from the shared sampler, if there is one that can be used.
+LexisSampler::Chooser RandomCallback::chooser(const Handle& key,
+                                              const HandleSeq& sects)
+{
+	if (_sampler and not _pruned and _sampler->weight_key() == _weight_key)
+		return _sampler->chooser(key, sects);
+	return LexisSampler::make(_weight_key, sects);
+}
+
 /// Perform a random draw of root sections.
 HandleSet RandomCallback::next_root(void)
 {
@@ -109,7 +137,7 @@ HandleSet RandomCallback::next_root(void)
 	HandleSet starters;
 	for (size_t i=0; i<len; i++)
 	{
-		size_t idx = _root_dist[i](rangen);
+		size_t idx = _root_dist[i](_rangen);
 		Handle root(_root_sections[i][idx]);
 		starters.insert(create_unique_section(root));
 	}
@@ -123,7 +151,7 @@ Handle RandomCallback::select_from_lexis(const OdoFrame& frame,
                                const Handle& fm_sect, size_t offset,
                                const Handle& to_con)
 {
-	const HandleSeq& to_sects = _dict.connectables(to_con);
+	const HandleSeq& to_sects = dict().connectables(to_con);
 
 	// Oh no, dead end!
 	if (0 == to_sects.size()) return Handle::UNDEFINED;
@@ -132,29 +160,14 @@ Handle RandomCallback::select_from_lexis(const OdoFrame& frame,
 	// If so, then use to pick a section, randomly.
 	auto curit = _distmap.find(to_con);
 	if (_distmap.end() != curit)
-	{
-		auto dist = curit->second;
-		return create_unique_section(to_sects[dist(rangen)]);
-	}
+		return create_unique_section(to_sects[curit->second(_rangen)]);
 
 	// Create a discrete distribution. This will randomly pick an
 	// index into the `to_sects` array. The weight of each index
-	// is given by the pdf aka "probability distribution function".
-	// The pdf is just given by the weighting-key hanging off the
-	// section (in a FloatValue).
-	std::vector<double> pdf;
-	for (const Handle& sect: to_sects)
-	{
-		FloatValuePtr fvp(FloatValueCast(sect->getValue(_weight_key)));
-		if (fvp)
-			pdf.push_back(fvp->value()[0]);
-		else
-			pdf.push_back(0.0);
-	}
-	std::discrete_distribution<size_t> dist(pdf.begin(), pdf.end());
-	_distmap.emplace(std::make_pair(to_con, dist));
-
-	return create_unique_section(to_sects[dist(rangen)]);
+	// is given by the weighting-key hanging off the section (in a
+	// FloatValue).
+	auto dist = _distmap.emplace(to_con, chooser(to_con, to_sects)).first;
+	return create_unique_section(to_sects[dist->second(_rangen)]);
 }
 
 /// Return a section containing `to_con`, from the set of currently
@@ -178,23 +191,23 @@ Handle RandomCallback::select_from_open(const OdoFrame& frame,
 	// ... and also CPU intensive. It might be faster to just
 	// choose on the fly, yeah? Don't know... needs investigation.
 
-	// Are there any attachable connectors?
+	// Have we already looked for attachable connectors?
 	auto tosit = _opensel._opensect.find(to_con);
-	if (_opensel._opensect.end() != tosit and tosit->second.size() == 0)
-		return Handle::UNDEFINED;
-
-	// If there's only one, pick it.
-	const HandleSeq& to_seclist = tosit->second;
-	if (to_seclist.size() == 1)
-		return to_seclist[0];
-
-	// Do we have a chooser for the to-connector in the current frame?
-	// If so, then use it.
-	auto curit = _opensel._opendi.find(to_con);
-	if (_opensel._opendi.end() != curit)
+	if (_opensel._opensect.end() != tosit)
 	{
-		auto dist = curit->second;
-		return to_seclist[dist(rangen)];
+		// Are there any attachable connectors?
+		const HandleSeq& to_seclist = tosit->second;
+		if (to_seclist.size() == 0)
+			return Handle::UNDEFINED;
+
+		// If there's only one, pick it.
+		if (to_seclist.size() == 1)
+			return to_seclist[0];
+
+		// Use the chooser for the to-connector in the current frame.
+		auto curit = _opensel._opendi.find(to_con);
+		if (_opensel._opendi.end() != curit)
+			return to_seclist[curit->second(_rangen)];
 	}
 
 	// Create a list of connectable sections
@@ -252,7 +265,7 @@ Handle RandomCallback::select_from_open(const OdoFrame& frame,
 	std::discrete_distribution<size_t> dist(pdf.begin(), pdf.end());
 	_opensel._opendi.emplace(std::make_pair(to_con, dist));
 
-	return to_sects[dist(rangen)];
+	return to_sects[dist(_rangen)];
 }
 
 /// Return a section containing `to_con`.
@@ -293,16 +306,21 @@ size_t RandomCallback::num_links(const Handle& fm_sect,
 	return num_undirected_links(fm_sect, to_sect, link_type);
 }
 
+/// Each new frame starts with no open selections, so the selections
+/// (and their distributions) are moved, not copied, onto the stack.
+/// See `SimpleCallback::push_frame()` for more.
 void RandomCallback::push_frame(const OdoFrame& frm)
 {
-	_opensel_stack.push(_opensel);
+	_opensel_stack.push(std::move(_opensel));
 	_opensel._opensect.clear();
 	_opensel._opendi.clear();
+	LinkStyle::push_scratch();
 }
 
 void RandomCallback::pop_frame(const OdoFrame& frm)
 {
-	_opensel = _opensel_stack.top(); _opensel_stack.pop();
+	_opensel = std::move(_opensel_stack.top()); _opensel_stack.pop();
+	LinkStyle::pop_scratch();
 }
 
 bool RandomCallback::step(const OdoFrame& frm)
@@ -316,6 +334,16 @@ bool RandomCallback::step(const OdoFrame& frm)
 	// return _parms->step(frm);
 }
 
+bool RandomCallback::viable(const OdoFrame& frm)
+{
+	return admissible(dict(), frm);
+}
+
+size_t RandomCallback::num_choices(const OdoFrame& frm, const Handle& to_con)
+{
+	return count_choices(dict(), frm, to_con);
+}
+
 void RandomCallback::solution(const OdoFrame& frm)
 {
 	record_solution(frm);
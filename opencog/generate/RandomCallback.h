@@ -22,9 +22,13 @@
 #ifndef _OPENCOG_RANDOM_CALLBACK_H
 #define _OPENCOG_RANDOM_CALLBACK_H
 
+#include <memory>
+#include <random>
+
 #include <opencog/generate/CollectStyle.h>
 #include <opencog/generate/Dictionary.h>
 #include <opencog/generate/GenerateCallback.h>
+#include <opencog/generate/LexisSampler.h>
 #include <opencog/generate/LinkStyle.h>
 #include <opencog/generate/RandomParameters.h>
 
@@ -38,6 +42,7 @@ namespace opencog
 /// current assembly. Under construction. Meant to draw pieces using
 /// a stochastic, random selection process.
 ///
+/// The dictionary is not copied; it must outlive the callback.
 
 class RandomCallback :
 	public GenerateCallback,
@@ -45,10 +50,23 @@ class RandomCallback :
 	private CollectStyle
 {
 private:
-	Dictionary _dict;
+	const Dictionary& _dict;
+
+	// The dictionary, less the sections that cannot be used with
+	// the current roots; set up by `root_set()`, if `prune_lexis`.
+	Dictionary _viable;
+	bool _pruned;
+	const Dictionary& dict(void) const {
+		return _pruned ? _viable : _dict;
+	}
 	RandomParameters* _parms;
 	Handle _weight_key;
 	size_t _steps_taken;
+	std::mt19937 _rangen;
+
+	// Choosers that outlive this callback; see `set_sampler()`.
+	std::shared_ptr<LexisSampler> _sampler;
+	LexisSampler::Chooser chooser(const Handle&, const HandleSeq&);
 
 	// -------------------------------------------
 	// Nucleation points.
@@ -89,11 +107,20 @@ public:
 	virtual void clear(AtomSpace*);
 	void set_weight_key(const Handle& pred) { _weight_key = pred; }
 
+	/// Draw the sections from the choosers kept in `sampler`, making
+	/// them there if need be, instead of making them afresh for each
+	/// run. The sampler must be for the same dictionary, and the same
+	/// weight key; it is not used when the lexis is pruned, as the
+	/// pruned lists of sections differ.
+	void set_sampler(const std::shared_ptr<LexisSampler>& sampler) {
+		_sampler = sampler;
+	}
+
 	virtual void root_set(const HandleSet&);
 	virtual HandleSet next_root(void);
 
-	virtual HandleSeq joints(const Handle& con) {
-		return _dict.joints(con);
+	virtual const HandleSeq& joints(const Handle& con) {
+		return dict().joints(con);
 	}
 	virtual Handle select(const OdoFrame&,
 	                      const Handle&, size_t,
@@ -105,10 +132,18 @@ public:
 	                         const Handle&);
 	virtual void push_frame(const OdoFrame&);
 	virtual void pop_frame(const OdoFrame&);
+	virtual void keep_scratch(void) { LinkStyle::keep_scratch(); }
 
 	virtual bool step(const OdoFrame&);
+	virtual bool viable(const OdoFrame&);
+	virtual size_t num_choices(const OdoFrame&, const Handle&);
 	virtual void solution(const OdoFrame&);
 	virtual Handle get_solutions(void);
+
+	virtual size_t num_solutions(void) {
+		return CollectStyle::num_solutions();
+	}
+	virtual size_t num_steps(void) { return _steps_taken; }
 };
 
 
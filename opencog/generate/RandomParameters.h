@@ -52,6 +52,9 @@ public:
 	/// taking an odometer step.  Returning false will abort the
 	/// current odometer.
 	virtual bool step(const OdoFrame&) = 0;
+
+	/// Re-seed the random number generator, if there is one.
+	virtual void seed(unsigned long) {}
 };
 
 
@@ -26,8 +26,9 @@
 using namespace opencog;
 
 SimpleCallback::SimpleCallback(AtomSpace* as, const Dictionary& dict)
-	: GenerateCallback(as), _dict(dict)
+	: GenerateCallback(as), _dict(dict), _viable(as)
 {
+	_pruned = false;
 	_steps_taken = 0;
 }
 
@@ -46,14 +47,30 @@ void SimpleCallback::clear(AtomSpace* scratch)
 	CollectStyle::clear();
 	LinkStyle::clear();
 	LinkStyle::_point_set = point_set;
+	CollectStyle::_isomorphic = dedup_isomorphic;
 	LinkStyle::_scratch = scratch;
+	if (random_seed) LinkStyle::seed(random_seed);
 }
 
 void SimpleCallback::root_set(const HandleSet& roots)
 {
+	_pruned = prune_lexis;
+	if (_pruned)
+	{
+		_viable = _dict;
+		_viable.prune(roots);
+	}
+
 	for (const Handle& point: roots)
 	{
-		_root_sections.push_back(_dict.entries(point));
+		// If any root has no sections, there are no solutions.
+		if (0 == dict().entries(point).size())
+		{
+			_root_sections.clear();
+			_root_iters.clear();
+			return;
+		}
+		_root_sections.push_back(dict().entries(point));
 		_root_iters.push_back(_root_sections.back().begin());
 	}
 }
@@ -101,32 +118,34 @@ Handle SimpleCallback::select_from_lexis(const OdoFrame& frame,
                                const Handle& fm_sect, size_t offset,
                                const Handle& to_con)
 {
-	const HandleSeq& to_sects = _dict.connectables(to_con);
+	const HandleSeq& to_sects = dict().connectables(to_con);
 
-	// Do we have an iterator (a future/promise) for the to-connector?
+	// Do we have an iterator (a future/promise) for this wheel?
 	// If not, then set one up. Else use the one we found.  The iterator
 	// that we are setting up here will point into the dictionary, i.e.
 	// into the pool of allowable sections that we can pick from.
-	unsigned curit = _lexlit.get(to_con, 0);
-	if (0 == curit)
+	Wheel wheel(fm_sect, offset, to_con);
+	auto lit = _lexlit.find(wheel);
+	if (_lexlit.end() == lit)
 	{
 		// Oh no, dead end!
 		if (0 == to_sects.size()) return Handle::UNDEFINED;
 
 		// Start it up.
-		_lexlit[to_con] = 1;
+		_lexlit.emplace(wheel, 1);
 		return create_unique_section(to_sects[0]);
 	}
 
+	unsigned curit = lit->second;
 	if (to_sects.size() <= curit)
 	{
 		// We've iterated to the end; we're done.
-		_lexlit.erase(to_con);
+		_lexlit.erase(lit);
 		return Handle::UNDEFINED;
 	}
 
 	// Increment and save.
-	_lexlit[to_con] ++;
+	lit->second ++;
 	return create_unique_section(to_sects[curit]);
 }
 
@@ -240,27 +259,35 @@ size_t SimpleCallback::num_links(const Handle& fm_sect,
 	return num_undirected_links(fm_sect, to_sect, link_type);
 }
 
+/// Each new frame starts with no open selections. Thus, the
+/// selections made in a frame are exactly the changes made since
+/// the push; these are moved (not copied) onto the stack, and moved
+/// back on pop. The cost is proportional to the selections made,
+/// and not to the total held in the stack.
 void SimpleCallback::push_frame(const OdoFrame& frm)
 {
-	_opensel_stack.push(_opensel);
+	_opensel_stack.push(std::move(_opensel));
 	_opensel._opensect.clear();
 	_opensel._openit.clear();
+	LinkStyle::push_scratch();
 }
 
 void SimpleCallback::pop_frame(const OdoFrame& frm)
 {
-	_opensel = _opensel_stack.top(); _opensel_stack.pop();
+	_opensel = std::move(_opensel_stack.top()); _opensel_stack.pop();
+	LinkStyle::pop_scratch();
 }
 
+/// Same as above: each odometer starts with fresh lexis iterators.
 void SimpleCallback::push_odometer(const Odometer& odo)
 {
-	_lexlit_stack.push(_lexlit);
+	_lexlit_stack.push(std::move(_lexlit));
 	_lexlit.clear();
 }
 
 void SimpleCallback::pop_odometer(const Odometer& odo)
 {
-	_lexlit = _lexlit_stack.top(); _lexlit_stack.pop();
+	_lexlit = std::move(_lexlit_stack.top()); _lexlit_stack.pop();
 }
 
 bool SimpleCallback::step(const OdoFrame& frm)
@@ -273,6 +300,16 @@ bool SimpleCallback::step(const OdoFrame& frm)
 	return true;
 }
 
+bool SimpleCallback::viable(const OdoFrame& frm)
+{
+	return admissible(dict(), frm);
+}
+
+size_t SimpleCallback::num_choices(const OdoFrame& frm, const Handle& to_con)
+{
+	return count_choices(dict(), frm, to_con);
+}
+
 void SimpleCallback::solution(const OdoFrame& frm)
 {
 	record_solution(frm);
@@ -22,6 +22,9 @@
 #ifndef _OPENCOG_SIMPLE_CALLBACK_H
 #define _OPENCOG_SIMPLE_CALLBACK_H
 
+#include <map>
+#include <tuple>
+
 #include <opencog/util/Counter.h>
 
 #include <opencog/generate/CollectStyle.h>
@@ -49,6 +52,8 @@ typedef Counter<Handle, unsigned> HandleUCounter;
 /// This behavior is useful only in certain small, limited cases, where
 /// the lexis has been designed to have only a finite number of possible
 /// solutions.
+///
+/// The dictionary is not copied; it must outlive the callback.
 
 class SimpleCallback :
 	public GenerateCallback,
@@ -56,7 +61,15 @@ class SimpleCallback :
 	private CollectStyle
 {
 private:
-	Dictionary _dict;
+	const Dictionary& _dict;
+
+	// The dictionary, less the sections that cannot be used with
+	// the current roots; set up by `root_set()`, if `prune_lexis`.
+	Dictionary _viable;
+	bool _pruned;
+	const Dictionary& dict(void) const {
+		return _pruned ? _viable : _dict;
+	}
 	size_t _steps_taken;
 
 	// -------------------------------------------
@@ -70,13 +83,18 @@ private:
 	                         const Handle&, size_t,
 	                         const Handle&);
 
-	// Iterator, pointing from a to-connector, to a list of
-	// all sections in the dictionary that contain this to-connector.
+	// Iterator, pointing from an odometer wheel, to a list of all
+	// sections in the dictionary that contain its to-connector. The
+	// wheel is the from-section, the offset of the from-connector,
+	// and the to-connector; two wheels with the same to-connector
+	// must not share an iterator, else neither ever rolls over.
 	// Used by `select()` to return the next attachable section.
-	HandleUCounter _lexlit;
+	typedef std::tuple<Handle, size_t, Handle> Wheel;
+	typedef std::map<Wheel, unsigned> WheelUCounter;
+	WheelUCounter _lexlit;
 
 	// Stack of iterators into the lists of sections.
-	std::stack<HandleUCounter> _lexlit_stack;
+	std::stack<WheelUCounter> _lexlit_stack;
 
 	// -------------------------------------------
 	Handle select_from_open(const OdoFrame&,
@@ -103,8 +121,10 @@ public:
 
 	virtual void clear(AtomSpace*);
 	virtual bool step(const OdoFrame&);
-	virtual HandleSeq joints(const Handle& con) {
-		return _dict.joints(con);
+	virtual bool viable(const OdoFrame&);
+	virtual size_t num_choices(const OdoFrame&, const Handle&);
+	virtual const HandleSeq& joints(const Handle& con) {
+		return dict().joints(con);
 	}
 
 	virtual void root_set(const HandleSet&);
@@ -120,10 +140,16 @@ public:
 	                         const Handle&);
 	virtual void push_frame(const OdoFrame&);
 	virtual void pop_frame(const OdoFrame&);
+	virtual void keep_scratch(void) { LinkStyle::keep_scratch(); }
 	virtual void push_odometer(const Odometer&);
 	virtual void pop_odometer(const Odometer&);
 	virtual void solution(const OdoFrame&);
 	virtual Handle get_solutions(void);
+
+	virtual size_t num_solutions(void) {
+		return CollectStyle::num_solutions();
+	}
+	virtual size_t num_steps(void) { return _steps_taken; }
 };
 
 
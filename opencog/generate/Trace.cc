@@ -0,0 +1,86 @@
+/*
+ * opencog/generate/Trace.cc
+ *
+ * Copyright (C) 2020 Linas Vepstas <linasvepstas@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <opencog/util/Logger.h>
+#include <opencog/atoms/base/Atom.h>
+
+#include "Trace.h"
+
+using namespace opencog;
+
+std::atomic<bool> Trace::_on(false);
+Trace::Sink Trace::_sink(Trace::log);
+
+void Trace::enable(Sink sink)
+{
+	_sink = sink ? sink : Sink(Trace::log);
+	_on = true;
+}
+
+void Trace::disable(void)
+{
+	_on = false;
+}
+
+const char* Trace::name(TraceEvent ev)
+{
+	switch (ev)
+	{
+		case TraceEvent::ENTER: return "enter";
+		case TraceEvent::ENTERED: return "entered";
+		case TraceEvent::NOT_VIABLE: return "not-viable";
+		case TraceEvent::DEAD_STATE: return "dead-state";
+		case TraceEvent::HALTED: return "halted";
+		case TraceEvent::ODO_INIT: return "odo-init";
+		case TraceEvent::ODO_STEP: return "odo-step";
+		case TraceEvent::WHEEL_CLOSED: return "wheel-closed";
+		case TraceEvent::WHEEL_ROLLOVER: return "wheel-rollover";
+		case TraceEvent::NO_STEP: return "no-step";
+		case TraceEvent::ODO_STEPPED: return "odo-stepped";
+		case TraceEvent::REDUNDANT: return "redundant";
+		case TraceEvent::RETRY: return "retry";
+		case TraceEvent::EXHAUSTED: return "exhausted";
+		case TraceEvent::EXPLORED: return "explored";
+		case TraceEvent::CONNECT: return "connect";
+		case TraceEvent::OPEN_POINT: return "open-point";
+		case TraceEvent::CLOSE_POINT: return "close-point";
+		case TraceEvent::FRAME_PUSH: return "frame-push";
+		case TraceEvent::FRAME_POP: return "frame-pop";
+		case TraceEvent::ODO_PUSH: return "odo-push";
+		case TraceEvent::ODO_POP: return "odo-pop";
+		case TraceEvent::SOLUTION: return "solution";
+		case TraceEvent::REDISCOVERY: return "rediscovery";
+	}
+	return "unknown";
+}
+
+/// The default sink: print the record to the log.
+void Trace::log(const TraceRecord& rec)
+{
+	if (rec.atom)
+		logger().fine("Trace %s depth=%lu %lu %lu %s", name(rec.event),
+			rec.depth, rec.a, rec.b, rec.atom->to_short_string().c_str());
+	else
+		logger().fine("Trace %s depth=%lu %lu %lu", name(rec.event),
+			rec.depth, rec.a, rec.b);
+}
+
+// ========================== END OF FILE ==========================
@@ -0,0 +1,125 @@
+/*
+ * opencog/generate/Trace.h
+ *
+ * Copyright (C) 2020 Linas Vepstas <linasvepstas@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_GENERATE_TRACE_H
+#define _OPENCOG_GENERATE_TRACE_H
+
+#include <atomic>
+#include <functional>
+
+#include <opencog/atoms/base/Handle.h>
+
+namespace opencog
+{
+/** \addtogroup grp_generate
+ *  @{
+ */
+
+/// Tracing of the aggregation hot path. Logging there is costly even
+/// when it is turned off, as the arguments are evaluated anyway: atoms
+/// are printed, and whole odometers walked, on every step. Instead, the
+/// aggregators emit trace records, via the `GEN_TRACE` macro. Unless
+/// the build defines `GENERATE_TRACE` (debug builds do), the macro
+/// expands to nothing at all, and its arguments are never evaluated.
+/// When it is compiled in, it is still off until turned on at run
+/// time, with `Trace::enable()`; this costs one atomic load per call.
+///
+/// The records are structured, not strings: an event, the odometer
+/// depth, two numbers whose meaning depends on the event, and maybe
+/// an atom. They go to a sink; the default sink prints them to the
+/// log, at the FINE level.
+enum class TraceEvent
+{
+	ENTER,          // a: frame depth
+	ENTERED,        // a: have-more
+	NOT_VIABLE,
+	DEAD_STATE,
+	HALTED,         // a: frame depth
+	ODO_INIT,       // a: number of wheels
+	ODO_STEP,       // a: wheel, b: number of wheels
+	WHEEL_CLOSED,   // a: wheel, b: number of wheels
+	WHEEL_ROLLOVER, // a: wheel, b: number of wheels
+	NO_STEP,        // a: wheel, b: number of wheels
+	ODO_STEPPED,    // a: open sections, b: linkage size
+	REDUNDANT,
+	RETRY,          // a: wheel
+	EXHAUSTED,
+	EXPLORED,       // a: have-more
+	CONNECT,        // a: from-offset, atom: from-section
+	OPEN_POINT,     // atom: point
+	CLOSE_POINT,    // atom: point
+	FRAME_PUSH,     // a: frame depth, b: open sections
+	FRAME_POP,      // a: frame depth, b: open sections
+	ODO_PUSH,
+	ODO_POP,
+	SOLUTION,       // a: solutions so far, b: solution size
+	REDISCOVERY,    // a: solutions so far, b: solution size
+};
+
+struct TraceRecord
+{
+	TraceEvent event;
+	size_t depth = 0;
+	size_t a = 0;
+	size_t b = 0;
+	Handle atom;
+};
+
+class Trace
+{
+public:
+	typedef std::function<void(const TraceRecord&)> Sink;
+
+private:
+	static std::atomic<bool> _on;
+	static Sink _sink;
+
+public:
+	/// Turn tracing on, sending the records to `sink`, or to the log,
+	/// if none is given. Not thread-safe with respect to a running
+	/// search; set the sink before starting.
+	static void enable(Sink sink = nullptr);
+	static void disable(void);
+
+	static bool on(void) { return _on.load(std::memory_order_relaxed); }
+	static void emit(const TraceRecord& rec) { _sink(rec); }
+
+	static const char* name(TraceEvent);
+	static void log(const TraceRecord&);
+};
+
+#ifdef GENERATE_TRACE
+	#define GEN_TRACE(EVENT, ...) \
+		do { if (opencog::Trace::on()) opencog::Trace::emit( \
+			{opencog::TraceEvent::EVENT, __VA_ARGS__}); } while (0)
+
+	/// Run `CODE` only when tracing is on; for the debug printers.
+	#define GEN_TRACE_DO(CODE) \
+		do { if (opencog::Trace::on()) { CODE; } } while (0)
+#else
+	#define GEN_TRACE(EVENT, ...) do {} while (0)
+	#define GEN_TRACE_DO(CODE) do {} while (0)
+#endif
+
+/** @}*/
+}  // namespace opencog
+
+#endif // _OPENCOG_GENERATE_TRACE_H
@@ -0,0 +1,79 @@
+/*
+ * opencog/generate/TranspositionTable.cc
+ *
+ * Copyright (C) 2020 Linas Vepstas <linasvepstas@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "TranspositionTable.h"
+
+using namespace opencog;
+
+TranspositionTable::TranspositionTable(size_t capacity)
+{
+	reset(capacity);
+}
+
+void TranspositionTable::reset(size_t capacity)
+{
+	_capacity = capacity;
+	_order.clear();
+	_index.clear();
+	_hits = 0;
+	_misses = 0;
+	_evictions = 0;
+}
+
+bool TranspositionTable::find(const std::string& key)
+{
+	if (0 == _capacity) return false;
+
+	auto fnd = _index.find(key);
+	if (_index.end() == fnd)
+	{
+		_misses ++;
+		return false;
+	}
+
+	_hits ++;
+	_order.splice(_order.begin(), _order, fnd->second);
+	return true;
+}
+
+void TranspositionTable::insert(const std::string& key)
+{
+	if (0 == _capacity) return;
+
+	auto ins = _index.emplace(key, _order.end());
+	if (not ins.second)
+	{
+		_order.splice(_order.begin(), _order, ins.first->second);
+		return;
+	}
+
+	_order.push_front(&ins.first->first);
+	ins.first->second = _order.begin();
+
+	if (_capacity < _index.size())
+	{
+		_index.erase(*_order.back());
+		_order.pop_back();
+		_evictions ++;
+	}
+}
+
+// ========================== END OF FILE ==========================
@@ -0,0 +1,82 @@
+/*
+ * opencog/generate/TranspositionTable.h
+ *
+ * Copyright (C) 2020 Linas Vepstas <linasvepstas@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_TRANSPOSITION_TABLE_H
+#define _OPENCOG_TRANSPOSITION_TABLE_H
+
+#include <list>
+#include <string>
+#include <unordered_map>
+
+namespace opencog
+{
+/** \addtogroup grp_generate
+ *  @{
+ */
+
+/// A bounded set of search states, keyed by strings. This is used to
+/// remember the states from which no solution could be reached, so
+/// that, when the same state is reached again by a different route,
+/// it is not explored a second time.
+///
+/// At most `capacity` states are kept. When full, the state that was
+/// least recently looked up (or added) is evicted. A capacity of zero
+/// disables the table: nothing is kept, and nothing is ever found.
+class TranspositionTable
+{
+	size_t _capacity;
+
+	/// Most recently used first. The list holds pointers to the keys
+	/// in the map; these stay put, as the map is node-based.
+	typedef std::list<const std::string*> Order;
+	Order _order;
+	std::unordered_map<std::string, Order::iterator> _index;
+
+	size_t _hits;
+	size_t _misses;
+	size_t _evictions;
+
+public:
+	TranspositionTable(size_t capacity = 0);
+
+	/// Remove all states, zero the counters, and set the capacity.
+	void reset(size_t capacity);
+
+	bool enabled(void) const { return 0 < _capacity; }
+	size_t size(void) const { return _index.size(); }
+
+	/// Return true if the state is in the table. This counts as a
+	/// hit or a miss, and marks the state as recently used.
+	bool find(const std::string&);
+
+	/// Add a state, evicting the least-recently-used one, if full.
+	void insert(const std::string&);
+
+	size_t hits(void) const { return _hits; }
+	size_t misses(void) const { return _misses; }
+	size_t evictions(void) const { return _evictions; }
+};
+
+
+/** @}*/
+}  // namespace opencog
+
+#endif // _OPENCOG_TRANSPOSITION_TABLE_H
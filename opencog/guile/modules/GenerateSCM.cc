@@ -19,14 +19,30 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+#include <opencog/util/Logger.h>
 #include <opencog/atoms/core/NumberNode.h>
 #include <opencog/atoms/core/StateLink.h>
+#include <opencog/atoms/value/FloatValue.h>
+#include <opencog/atoms/value/LinkValue.h>
+#include <opencog/atoms/value/StringValue.h>
 #include <opencog/guile/SchemeModule.h>
 #include <opencog/guile/SchemePrimitive.h>
 
 #include <opencog/generate/Aggregate.h>
+#include <opencog/generate/CompactAggregate.h>
+#include <opencog/generate/CompactLexis.h>
 #include <opencog/generate/Dictionary.h>
 #include <opencog/generate/BasicParameters.h>
+#include <opencog/generate/GrowthAnalysis.h>
+#include <opencog/generate/LexisSampler.h>
+#include <opencog/generate/ParallelAggregate.h>
+#include <opencog/generate/PopulationAggregate.h>
 #include <opencog/generate/RandomCallback.h>
 #include <opencog/generate/SimpleCallback.h>
 
@@ -43,8 +59,105 @@ class GenerateSCM : public ModuleWrap
 protected:
 	virtual void init();
 
+	// Dictionaries pulled out of the atomspace, by the atomspace, and
+	// by their poles, lexis and weight anchors, so that repeated calls
+	// with the same anchors need not pull them out again. An entry is
+	// good for as long as its atomspace lives, and the MemberLinks of
+	// the poles and the lexis anchors, and the weights of the sections,
+	// stay the same. Entries in use are not changed; a stale one is
+	// replaced. The signatures and the `editing` flag are guarded by
+	// `_lex_mtx`; the rest belongs to whoever took the entry for
+	// editing, while it is being edited.
+	struct Lexis
+	{
+		std::weak_ptr<AtomSpace> as;
+		size_t poles_sig;
+		size_t lexis_sig;
+		size_t weight_sig;
+		bool editing = false;
+		HandleSet members;
+		Dictionary dict;
+
+		// The choosers of the `RandomCallback`, for the weight key.
+		std::shared_ptr<LexisSampler> sampler;
+
+		// The dictionary, flattened for the compact engine; made when
+		// first needed.
+		std::mutex mtx;
+		std::unique_ptr<CompactLexis> compact;
+		const CompactLexis& get_compact(const Handle&);
+
+		Lexis(const Dictionary& d, const Handle& weight) :
+			dict(d), sampler(new LexisSampler(weight)) {
+			dict.add_sampler(sampler);
+		}
+	};
+	typedef std::tuple<AtomSpace*, Handle, Handle, Handle> LexisKey;
+	std::map<LexisKey, std::shared_ptr<Lexis>> _lexes;
+	std::mutex _lex_mtx;
+
+	std::shared_ptr<Lexis> get_lexis(const AtomSpacePtr&,
+	                                 Handle, Handle, Handle, Handle);
+	void do_clear_lexis_cache(void);
+	bool update_lexis(Lexis&, const Handle&, const Handle&, size_t);
+	void do_set_weight(Handle, Handle, Handle);
+
+	Handle compact_aggregate(AtomSpace*, Lexis*,
+	                         std::unique_ptr<CompactLexis>,
+	                         Handle, Handle, Handle,
+	                         GenerateCallback&, RandomParameters*);
 	Handle do_random_aggregate(Handle, Handle, Handle, Handle, Handle);
+	Handle parallel_random_aggregate(AtomSpace*, Lexis&,
+	                                 Handle, Handle, Handle,
+	                                 RandomCallback&, BasicParameters&);
 	Handle do_simple_aggregate(Handle, Handle, Handle, Handle);
+	Handle do_compile_lexis(Handle, Handle, Handle, Handle);
+	Handle do_analyze_growth(Handle, Handle, Handle, Handle, Handle);
+
+	// Aggregations that are running now, by their parameter anchor,
+	// so that they can be cancelled from other threads. Registered
+	// for as long as a `Running` is in scope.
+	std::multimap<Handle, std::atomic<bool>*> _running;
+	class Running
+	{
+		GenerateSCM* _scm;
+		std::multimap<Handle, std::atomic<bool>*>::iterator _it;
+		std::atomic<bool> _cancel;
+	public:
+		Running(GenerateSCM*, const Handle&, GenerateCallback&);
+		~Running();
+	};
+
+	// Aggregations that hand out one solution at a time. A session
+	// is held by the table, and by each call working on it, so that
+	// closing it does not pull it out from under a running call. The
+	// session mutex is held for the whole of a call; calls on the
+	// same session take turns.
+	struct Session
+	{
+		AtomSpace* as;
+		std::shared_ptr<Lexis> lex;
+		BasicParameters basic;
+		std::unique_ptr<GenerateCallback> cb;
+		Aggregate ag;
+		Handle params;
+		std::atomic<bool> cancel;
+		std::mutex mtx;
+		bool done;
+
+		Session(AtomSpace* a, const std::shared_ptr<Lexis>& l) :
+			as(a), lex(l), ag(a), cancel(false), done(false) {}
+	};
+	std::map<Handle, std::shared_ptr<Session>> _sessions;
+	std::mutex _sess_mtx;
+	size_t _sess_count;
+
+	Handle add_session(std::shared_ptr<Session>, Handle);
+	Handle do_random_start(Handle, Handle, Handle, Handle, Handle);
+	Handle do_simple_start(Handle, Handle, Handle, Handle);
+	Handle do_next_solution(Handle);
+	void do_close(Handle);
+	void do_cancel(Handle);
 
 public:
 	GenerateSCM();
@@ -86,6 +199,17 @@ void decode_param(const Handle& membli,
 		return;
 	}
 
+	// The file name is the name of the node.
+	if (0 == sname.compare("*-lexis-file-*"))
+	{
+		if (not pval->is_node())
+			throw InvalidParamException(TRACE_INFO,
+				"Expecting a file name, got %s",
+				pval->to_short_string());
+		cb.lexis_file = pval->get_name();
+		return;
+	}
+
 	// All parameters below here expect a NumberNode
 	if (not nameserver().isA(pval->get_type(), NUMBER_NODE))
 		throw InvalidParamException(TRACE_INFO,
@@ -99,12 +223,56 @@ void decode_param(const Handle& membli,
 	else if (0 == sname.compare("*-max-steps-*"))
 		cb.max_steps = dval;
 
+	else if (0 == sname.compare("*-max-time-*"))
+		cb.max_time = dval;
+
 	else if (0 == sname.compare("*-max-depth-*"))
 		cb.max_depth = dval;
 
 	else if(0 == sname.compare("*-max-network-size-*"))
 		cb.max_network_size = dval;
 
+	else if (0 == sname.compare("*-num-threads-*"))
+		cb.num_threads = (1.0 < dval) ? dval : 1;
+
+	else if (0 == sname.compare("*-compact-engine-*"))
+		cb.compact_engine = (0.0 != dval);
+
+	else if (0 == sname.compare("*-dedup-isomorphic-*"))
+		cb.dedup_isomorphic = (0.0 != dval);
+
+	else if (0 == sname.compare("*-break-symmetry-*"))
+		cb.break_symmetry = (0.0 != dval);
+
+	else if (0 == sname.compare("*-memo-size-*"))
+		cb.memo_size = dval;
+
+	else if (0 == sname.compare("*-prune-lexis-*"))
+		cb.prune_lexis = (0.0 != dval);
+
+	else if (0 == sname.compare("*-admissible-bounds-*"))
+		cb.admissible_bounds = (0.0 != dval);
+
+	else if (0 == sname.compare("*-auto-bounds-*"))
+		cb.auto_bounds = (0.0 != dval);
+
+	else if (0 == sname.compare("*-most-constrained-first-*"))
+		cb.most_constrained_first = (0.0 != dval);
+
+	else if (0 == sname.compare("*-population-size-*"))
+	{
+		// Unlike the limits above, -1 is not "unlimited": the whole
+		// population is held in memory.
+		if (dval < 0.0)
+			throw InvalidParamException(TRACE_INFO,
+				"Expecting a population size of zero or more, got %s",
+				pval->to_short_string());
+		cb.population_size = dval;
+	}
+
+	else if (0 == sname.compare("*-random-seed-*"))
+		cb.random_seed = dval;
+
 	else if (0 == sname.compare("*-close-fraction-*"))
 		basic.close_fraction = dval;
 }
@@ -125,6 +293,91 @@ void decode_params(const Handle& param_anchor,
 }
 
 // ----------------------------------------------------------------
+/// Attach the search statistics to the parameter anchor, so that they
+/// can be looked at after the search. They are a LinkValue of pairs,
+/// each pair being a StringValue name, and a FloatValue; the pairs are
+/// turned into an association list by `cog-aggregate-stats`.
+void record_stats(AtomSpace* as, const Handle& params,
+                  const AggregateStats& st)
+{
+	std::vector<ValuePtr> pairs;
+	auto add = [&](const std::string& name, const std::vector<double>& v)
+	{
+		pairs.push_back(createLinkValue(std::vector<ValuePtr>(
+			{createStringValue(name), createFloatValue(v)})));
+	};
+	auto hist = [](const std::vector<size_t>& h)
+	{
+		return std::vector<double>(h.begin(), h.end());
+	};
+
+	add("odometer-pushes", {(double) st.odo_pushes});
+	add("odometer-pops", {(double) st.odo_pops});
+	add("frame-pushes", {(double) st.frame_pushes});
+	add("selects", {(double) st.selects});
+	add("null-selects", {(double) st.null_selects});
+	add("rollovers", {(double) st.rollovers});
+	add("solutions", {(double) st.solutions});
+	add("rediscoveries", {(double) st.rediscoveries});
+	add("max-depth", {(double) st.max_depth});
+	add("scratch-atoms", {(double) st.scratch_atoms});
+	add("first-solution-secs", {st.first_solution});
+	add("elapsed-secs", {st.elapsed});
+	add("depth-odometers", hist(st.depth_odometers));
+	add("depth-wheels", hist(st.depth_wheels));
+
+	Handle key(as->add_node(PREDICATE_NODE, "*-aggregate-stats-*"));
+	params->setValue(key, createLinkValue(pairs));
+}
+
+/// Analyze the growth of the networks grown from the root, and attach
+/// the results to the parameter anchor, in the same way as the search
+/// statistics; see `cog-growth-analysis`.
+GrowthStats analyze_growth(AtomSpace* as, const Dictionary& dict,
+                           const Handle& weight, const Handle& params,
+                           const Handle& root)
+{
+	GrowthAnalysis ga(dict, weight);
+	GrowthStats gs(ga.analyze({root}));
+	gs.print();
+	if (gs.extinction < 0.01)
+		logger().warn("Growth: only %g of the networks stop growing",
+			gs.extinction);
+
+	std::vector<ValuePtr> pairs;
+	auto add = [&](const std::string& name, double val)
+	{
+		pairs.push_back(createLinkValue(std::vector<ValuePtr>(
+			{createStringValue(name), createFloatValue(val)})));
+	};
+	add("spectral-radius", gs.spectral_radius);
+	add("extinction", gs.extinction);
+	add("mean-size", gs.mean_size);
+	add("size-deviation", gs.size_deviation);
+	add("mean-depth", gs.mean_depth);
+	add("suggested-size", gs.suggested_size);
+	add("suggested-depth", gs.suggested_depth);
+
+	Handle key(as->add_node(PREDICATE_NODE, "*-growth-analysis-*"));
+	params->setValue(key, createLinkValue(pairs));
+	return gs;
+}
+
+// ----------------------------------------------------------------
+/// The sections that are members of the lexis.
+HandleSeq lexis_members(const Handle& lexis)
+{
+	HandleSeq membs = lexis->getIncomingSetByType(MEMBER_LINK);
+	HandleSeq sects;
+	sects.reserve(membs.size());
+	for (const Handle& membli : membs)
+	{
+		if (*membli->getOutgoingAtom(1) != *lexis) continue;
+		sects.push_back(membli->getOutgoingAtom(0));
+	}
+	return sects;
+}
+
 /// Pull the lexis out of the atomspace.
 Dictionary decode_lexis(AtomSpace* as, Handle poles, Handle lexis)
 {
@@ -148,14 +401,349 @@ Dictionary decode_lexis(AtomSpace* as, Handle poles, Handle lexis)
 		}
 	}
 
-	// Add the sections to the dictionary.
-	HandleSeq sects = lexis->getIncomingSetByType(MEMBER_LINK);
-	for (const Handle& membli : sects)
+	// Add the sections to the dictionary, all at once.
+	dict.add_to_lexis(lexis_members(lexis));
+	return dict;
+}
+
+// ----------------------------------------------------------------
+/// A signature of the MemberLinks holding the anchor; it changes when
+/// one is added or removed (barring a collision of the hashes). This
+/// walks the incoming set, which is much cheaper than building the
+/// dictionary.
+size_t member_sig(const Handle& anchor)
+{
+	HandleSeq membs = anchor->getIncomingSetByType(MEMBER_LINK);
+	size_t sig = membs.size();
+	for (const Handle& membli : membs)
+		sig += membli->get_hash() * 0x9e3779b97f4a7c15ULL;
+	return sig;
+}
+
+/// The part of the weight signature for one section: the hash of its
+/// weight, at the weight key, if it has one.
+size_t weight_term(const Handle& sect, const Handle& key)
+{
+	FloatValuePtr fvp(FloatValueCast(sect->getValue(key)));
+	if (nullptr == fvp or fvp->value().empty()) return 0;
+	size_t wh = std::hash<double>()(fvp->value()[0]);
+	return (sect->get_hash() ^ wh) * 0x9e3779b97f4a7c15ULL;
+}
+
+/// A signature of the weights of the sections of the lexis; it changes
+/// when one of them is changed, e.g. with `cog-set-value!`. This is a
+/// sum over the sections, so that one changed weight can be accounted
+/// for without walking them all. Costs one value lookup per section.
+size_t weight_sig(const Handle& lexis, const Handle& key)
+{
+	if (nullptr == key) return 0;
+	size_t sig = 0;
+	for (const Handle& sect : lexis_members(lexis))
+		sig += weight_term(sect, key);
+	return sig;
+}
+
+/// Return the dictionary for the anchors, pulling it out of the
+/// atomspace only if it is not cached, or the cached one is stale.
+/// If only the lexis or the weights changed, and the cached one is not
+/// in use, then just the sections that were added or removed are
+/// updated; if the weights changed, the choosers are forgotten. Entries
+/// for atomspaces that are gone are dropped; a new atomspace at the
+/// same address does not get the old entries. Which of these happened
+/// is noted on `params`, as "reused", "updated" or "built".
+std::shared_ptr<GenerateSCM::Lexis>
+GenerateSCM::get_lexis(const AtomSpacePtr& asp, Handle poles, Handle lexis,
+                       Handle weight, Handle params)
+{
+	AtomSpace* as = asp.get();
+	Handle how(as->add_node(PREDICATE_NODE, "*-lexis-cache-*"));
+	LexisKey key(as, poles, lexis, weight);
+	size_t psig = member_sig(poles);
+	size_t lsig = member_sig(lexis);
+	size_t wsig = weight_sig(lexis, weight);
+
+	// Take a stale entry that is not in use for editing; holding it
+	// puts it in use, so that no one else touches it meanwhile. The
+	// edit is done without holding the lock.
+	std::shared_ptr<Lexis> lex;
+	{
+		std::lock_guard<std::mutex> lck(_lex_mtx);
+		auto it = _lexes.find(key);
+		if (_lexes.end() != it and asp == it->second->as.lock() and
+		    psig == it->second->poles_sig)
+		{
+			lex = it->second;
+			if (lsig == lex->lexis_sig and wsig == lex->weight_sig)
+			{
+				params->setValue(how, createStringValue("reused"));
+				return lex;
+			}
+			if (2 == lex.use_count()) lex->editing = true;
+			else lex.reset();
+		}
+	}
+
+	if (lex)
 	{
-		if (*membli->getOutgoingAtom(1) != *lexis) continue;
-		dict.add_to_lexis(membli->getOutgoingAtom(0));
+		bool reweigh = (wsig != lex->weight_sig);
+		if (lsig != lex->lexis_sig)
+			reweigh = update_lexis(*lex, lexis, weight, wsig);
+		if (reweigh)
+		{
+			lex->sampler->clear();
+			lex->compact.reset();
+		}
+
+		std::lock_guard<std::mutex> lck(_lex_mtx);
+		lex->lexis_sig = lsig;
+		lex->weight_sig = wsig;
+		lex->editing = false;
+		params->setValue(how, createStringValue("updated"));
+		return lex;
 	}
-	return dict;
+
+	HandleSeq sects(lexis_members(lexis));
+	lex.reset(new Lexis(decode_lexis(as, poles, lexis), weight));
+	lex->as = asp;
+	lex->members.insert(sects.begin(), sects.end());
+	lex->poles_sig = psig;
+	lex->lexis_sig = lsig;
+	lex->weight_sig = wsig;
+
+	std::lock_guard<std::mutex> lck(_lex_mtx);
+	for (auto it = _lexes.begin(); it != _lexes.end(); )
+	{
+		if (it->second->as.expired()) it = _lexes.erase(it);
+		else it++;
+	}
+	_lexes[key] = lex;
+	params->setValue(how, createStringValue("built"));
+	return lex;
+}
+
+/// Bring the lexis of the dictionary up to date with the members of
+/// the lexis anchor. The members are compared to those seen the last
+/// time, and only the sections that were added or removed are added
+/// to, or removed from the dictionary; the choosers of the sampler
+/// that draw them are forgotten. The compact lexis is made again, if
+/// needed. Returns true if the weights changed as well, i.e. if the
+/// weight signature, moved along with the sections, is not `wsig`.
+/// A removed section whose weight was changed counts as a change.
+bool GenerateSCM::update_lexis(Lexis& lex, const Handle& lexis,
+                               const Handle& weight, size_t wsig)
+{
+	HandleSeq sects(lexis_members(lexis));
+	HandleSet now(sects.begin(), sects.end());
+
+	size_t sig = lex.weight_sig;
+	for (auto it = lex.members.begin(); it != lex.members.end(); )
+	{
+		if (0 < now.count(*it)) { it++; continue; }
+		lex.dict.remove_from_lexis(*it);
+		if (weight) sig -= weight_term(*it, weight);
+		it = lex.members.erase(it);
+	}
+
+	for (const Handle& sect : sects)
+	{
+		if (not lex.members.insert(sect).second) continue;
+		lex.dict.add_to_lexis(sect);
+		if (weight) sig += weight_term(sect, weight);
+	}
+
+	lex.compact.reset();
+	return sig != wsig;
+}
+
+/// Set the weight of a section, and update the cached dictionaries
+/// that hold it, without rebuilding them. A cached dictionary that
+/// is in use is dropped instead, and made afresh when next needed.
+void GenerateSCM::do_set_weight(Handle sect, Handle key, Handle weight)
+{
+	if (not nameserver().isA(weight->get_type(), NUMBER_NODE))
+		throw InvalidParamException(TRACE_INFO,
+			"Expecting a numerical value, got %s",
+			weight->to_short_string());
+	double dval = NumberNodeCast(weight)->get_value();
+	size_t before = weight_term(sect, key);
+	sect->setValue(key, createFloatValue(dval));
+	size_t after = weight_term(sect, key);
+
+	std::lock_guard<std::mutex> lck(_lex_mtx);
+	for (auto it = _lexes.begin(); it != _lexes.end(); )
+	{
+		Lexis& lex = *it->second;
+		if (lex.as.expired() or lex.editing)
+		{
+			it = _lexes.erase(it);
+			continue;
+		}
+		if (not lex.dict.in_lexis(sect)) { it++; continue; }
+		if (1 < it->second.use_count()) { it = _lexes.erase(it); continue; }
+
+		lex.dict.set_weight(sect, key, dval);
+		if (key == std::get<3>(it->first))
+		{
+			lex.weight_sig += after - before;
+			lex.compact.reset();
+		}
+		it++;
+	}
+}
+
+/// Forget all of the cached dictionaries. Never needed for correctness,
+/// as changes to the anchors and to the weights are noticed; this just
+/// frees the memory.
+void GenerateSCM::do_clear_lexis_cache(void)
+{
+	std::lock_guard<std::mutex> lck(_lex_mtx);
+	_lexes.clear();
+}
+
+const CompactLexis& GenerateSCM::Lexis::get_compact(const Handle& weight)
+{
+	std::lock_guard<std::mutex> lck(mtx);
+	if (compact) return *compact;
+	compact.reset(new CompactLexis(dict));
+	if (weight) compact->set_weights(weight);
+	return *compact;
+}
+
+// ----------------------------------------------------------------
+/// The value of the parameter `name` in the parameter set `params`,
+/// or null, if it is not set. See `decode_param()` for the encoding.
+Handle get_param(const Handle& params, const std::string& name)
+{
+	for (const Handle& membli : params->getIncomingSetByType(MEMBER_LINK))
+	{
+		if (*membli->getOutgoingAtom(1) != *params) continue;
+		const Handle& pname = membli->getOutgoingAtom(0);
+		if (not pname->is_node() or 0 != name.compare(pname->get_name()))
+			continue;
+		Handle statli = StateLink::get_link(membli);
+		if (statli) return statli->getOutgoingAtom(1);
+	}
+	return Handle::UNDEFINED;
+}
+
+/// The signature saved in a compiled lexis file: that of the
+/// MemberLinks of the poles and the lexis anchors it was made from.
+uint64_t file_sig(size_t poles_sig, size_t lexis_sig)
+{
+	return poles_sig * 0x9e3779b97f4a7c15ULL + lexis_sig;
+}
+
+/// Map the compiled lexis file named in the parameters, if the
+/// compact engine is to be used, and the file was compiled from the
+/// poles and lexis as they are now. Otherwise, return null; the lexis
+/// is then pulled out of the atomspace, and the file written afresh.
+/// This is decided once, here; the file is opened only once.
+std::unique_ptr<CompactLexis> map_lexis_file(AtomSpace* as,
+                                             const Handle& poles,
+                                             const Handle& lexis,
+                                             const Handle& params)
+{
+	Handle engine(get_param(params, "*-compact-engine-*"));
+	Handle file(get_param(params, "*-lexis-file-*"));
+	if (nullptr == engine or nullptr == file or not file->is_node())
+		return nullptr;
+	if (not nameserver().isA(engine->get_type(), NUMBER_NODE) or
+	    0.0 == NumberNodeCast(engine)->get_value())
+		return nullptr;
+
+	const std::string& path = file->get_name();
+	std::unique_ptr<CompactLexis> mapped;
+	try
+	{
+		mapped.reset(new CompactLexis(as, path));
+	}
+	catch (const RuntimeException& ex)
+	{
+		logger().info("Not using lexis file %s: %s", path.c_str(),
+			ex.what());
+		return nullptr;
+	}
+
+	if (mapped->signature() != file_sig(member_sig(poles), member_sig(lexis)))
+	{
+		logger().info("Lexis file %s is out of date; compiling it again",
+			path.c_str());
+		return nullptr;
+	}
+	return mapped;
+}
+
+/// Run the compact engine. If a compiled lexis file was mapped (see
+/// `map_lexis_file()`), then it is used, and `lex` is null. Otherwise,
+/// if a file was named, the lexis is saved to it, for next time. The
+/// saved lexis is not pruned, as it is not specific to the root.
+Handle GenerateSCM::compact_aggregate(AtomSpace* as, Lexis* lex,
+                                      std::unique_ptr<CompactLexis> mapped,
+                                      Handle weight, Handle params,
+                                      Handle root, GenerateCallback& cb,
+                                      RandomParameters* parms)
+{
+	const std::string& file = cb.lexis_file;
+
+	// The cached lexis is used as-is; a pruned one is made afresh.
+	std::unique_ptr<CompactLexis> own(std::move(mapped));
+	if (nullptr == own and 0 == file.size() and cb.prune_lexis)
+	{
+		Dictionary viable(lex->dict);
+		viable.prune({root});
+		own.reset(new CompactLexis(viable));
+	}
+	if (own and weight) own->set_weights(weight);
+
+	const CompactLexis& clex = own ? *own : lex->get_compact(weight);
+	if (lex and 0 < file.size())
+		clex.save(file, file_sig(lex->poles_sig, lex->lexis_sig));
+
+	CompactAggregate cag(as, clex);
+	if (parms) cag.aggregate({root}, cb, *parms);
+	else cag.aggregate({root}, cb);
+	record_stats(as, params, cag.stats());
+
+	Handle result = cag.get_solutions();
+	result = as->add_atom(result);
+	return result;
+}
+
+/// C++ implementation of the scheme function.
+Handle GenerateSCM::do_compile_lexis(Handle poles,
+                                     Handle lexis,
+                                     Handle weight,
+                                     Handle file)
+{
+	AtomSpacePtr asp = SchemeSmob::ss_get_env_as("cog-compile-lexis");
+	AtomSpace* as = asp.get();
+
+	if (not file->is_node())
+		throw InvalidParamException(TRACE_INFO,
+			"Expecting a file name, got %s", file->to_short_string());
+
+	size_t psig = member_sig(poles);
+	size_t lsig = member_sig(lexis);
+	Dictionary dict(decode_lexis(as, poles, lexis));
+	CompactLexis lex(dict);
+	lex.set_weights(weight);
+	lex.save(file->get_name(), file_sig(psig, lsig));
+	return file;
+}
+
+/// C++ implementation of the scheme function.
+Handle GenerateSCM::do_analyze_growth(Handle poles,
+                                      Handle lexis,
+                                      Handle weight,
+                                      Handle params,
+                                      Handle root)
+{
+	AtomSpacePtr asp = SchemeSmob::ss_get_env_as("cog-analyze-growth");
+	AtomSpace* as = asp.get();
+
+	std::shared_ptr<Lexis> lex(get_lexis(asp, poles, lexis, weight, params));
+	analyze_growth(as, lex->dict, weight, params, root);
+	return params;
 }
 
 // ----------------------------------------------------------------
@@ -169,23 +757,96 @@ Handle GenerateSCM::do_random_aggregate(Handle poles,
 	AtomSpacePtr asp = SchemeSmob::ss_get_env_as("cog-random-aggregate");
 	AtomSpace* as = asp.get();
 
-	Dictionary dict(decode_lexis(as, poles, lexis));
+	// A compiled lexis file is used instead, if there is one.
+	std::unique_ptr<CompactLexis> mapped(
+		map_lexis_file(as, poles, lexis, params));
+	std::shared_ptr<Lexis> lex;
+	if (nullptr == mapped)
+		lex = get_lexis(asp, poles, lexis, weight, params);
+	Dictionary empty(as);
 
 	BasicParameters basic;
-	RandomCallback cb(as, dict, basic);
+	RandomCallback cb(as, lex ? lex->dict : empty, basic);
 	cb.set_weight_key(weight);
+	if (lex) cb.set_sampler(lex->sampler);
 
 	// Decode the parameters.
 	decode_params(params, cb, basic);
+	Running running(this, params, cb);
+
+	if (cb.auto_bounds and lex)
+		GrowthAnalysis::apply(
+			analyze_growth(as, lex->dict, weight, params, root), cb);
+
+	if (cb.compact_engine)
+		return compact_aggregate(as, lex.get(), std::move(mapped),
+		                         weight, params, root, cb, &basic);
+
+	if (0 < cb.population_size)
+	{
+		PopulationAggregate pag(as);
+		pag.aggregate({root}, cb);
+		record_stats(as, params, pag.stats());
+
+		Handle result = cb.get_solutions();
+		result = as->add_atom(result);
+		return result;
+	}
+
+	if (1 < cb.num_threads)
+		return parallel_random_aggregate(as, *lex, weight, params, root,
+		                                 cb, basic);
 
 	Aggregate ag(as);
 	ag.aggregate({root}, cb);
+	record_stats(as, params, ag.stats());
 
 	Handle result = cb.get_solutions();
 	result = as->add_atom(result);
 	return result;
 }
 
+/// Multi-threaded variant of the above. Each thread gets its own
+/// callback and parameters, as these hold random number generators
+/// and other state that cannot be shared. The first of these is the
+/// one that was already set up by the caller.
+Handle GenerateSCM::parallel_random_aggregate(AtomSpace* as,
+                                              Lexis& lex,
+                                              Handle weight,
+                                              Handle params,
+                                              Handle root,
+                                              RandomCallback& cb,
+                                              BasicParameters& basic)
+{
+	size_t nthreads = cb.num_threads;
+
+	std::vector<std::unique_ptr<BasicParameters>> bparms;
+	std::vector<std::unique_ptr<RandomCallback>> rcbs;
+	std::vector<GenerateCallback*> workers;
+	workers.push_back(&cb);
+	for (size_t i = 1; i < nthreads; i++)
+	{
+		bparms.emplace_back(new BasicParameters());
+		rcbs.emplace_back(new RandomCallback(as, lex.dict, *bparms.back()));
+		rcbs.back()->set_weight_key(weight);
+		rcbs.back()->set_sampler(lex.sampler);
+		decode_params(params, *rcbs.back(), *bparms.back());
+		rcbs.back()->max_depth = cb.max_depth;
+		rcbs.back()->max_network_size = cb.max_network_size;
+		rcbs.back()->cancel = cb.cancel;
+		if (cb.random_seed) rcbs.back()->random_seed += i;
+		workers.push_back(rcbs.back().get());
+	}
+
+	ParallelAggregate pag(as);
+	pag.aggregate({root}, workers);
+	record_stats(as, params, pag.stats());
+
+	Handle result = pag.get_solutions();
+	result = as->add_atom(result);
+	return result;
+}
+
 // ----------------------------------------------------------------
 /// C++ implementation of the scheme function.
 Handle GenerateSCM::do_simple_aggregate(Handle poles,
@@ -196,24 +857,196 @@ Handle GenerateSCM::do_simple_aggregate(Handle poles,
 	AtomSpacePtr asp = SchemeSmob::ss_get_env_as("cog-simple-aggregate");
 	AtomSpace* as = asp.get();
 
-	Dictionary dict(decode_lexis(as, poles, lexis));
+	std::unique_ptr<CompactLexis> mapped(
+		map_lexis_file(as, poles, lexis, params));
+	std::shared_ptr<Lexis> lex;
+	if (nullptr == mapped)
+		lex = get_lexis(asp, poles, lexis, Handle::UNDEFINED, params);
+	Dictionary empty(as);
 
 	BasicParameters basic;
-	SimpleCallback cb(as, dict);
+	SimpleCallback cb(as, lex ? lex->dict : empty);
 	decode_params(params, cb, basic);
+	Running running(this, params, cb);
+
+	if (cb.compact_engine)
+		return compact_aggregate(as, lex.get(), std::move(mapped),
+		                         Handle::UNDEFINED, params, root, cb, nullptr);
+
+	if (1 < cb.num_threads)
+	{
+		// Each thread gets its own callback; the first is the one
+		// that was already set up above.
+		std::vector<std::unique_ptr<SimpleCallback>> scbs;
+		std::vector<GenerateCallback*> workers;
+		workers.push_back(&cb);
+		for (size_t i = 1; i < cb.num_threads; i++)
+		{
+			scbs.emplace_back(new SimpleCallback(as, lex->dict));
+			decode_params(params, *scbs.back(), basic);
+			scbs.back()->cancel = cb.cancel;
+
+			// The threads share one scratch space; with the same
+			// seed, they would make the same "unique" point names.
+			if (cb.random_seed) scbs.back()->random_seed += i;
+			workers.push_back(scbs.back().get());
+		}
+
+		ParallelAggregate pag(as);
+		pag.enumerate({root}, workers);
+		record_stats(as, params, pag.stats());
+
+		Handle result = pag.get_solutions();
+		result = as->add_atom(result);
+		return result;
+	}
 
 	Aggregate ag(as);
 	ag.aggregate({root}, cb);
+	record_stats(as, params, ag.stats());
 
 	Handle result = cb.get_solutions();
 	result = as->add_atom(result);
 	return result;
 }
 
+// ----------------------------------------------------------------
+/// Remember the session, and start it going. Returns the handle that
+/// identifies it.
+Handle GenerateSCM::add_session(std::shared_ptr<Session> sess, Handle root)
+{
+	sess->cb->cancel = &sess->cancel;
+	sess->ag.start({root}, *sess->cb);
+
+	std::lock_guard<std::mutex> lck(_sess_mtx);
+	Handle key(createNode(ANCHOR_NODE,
+		"aggregation session " + std::to_string(++_sess_count)));
+	_sessions[key] = std::move(sess);
+	return key;
+}
+
+/// Same as `do_random_aggregate()`, but don't run it; instead, return
+/// a session, from which solutions can be pulled one at a time.
+Handle GenerateSCM::do_random_start(Handle poles,
+                                    Handle lexis,
+                                    Handle weight,
+                                    Handle params,
+                                    Handle root)
+{
+	AtomSpacePtr asp = SchemeSmob::ss_get_env_as("cog-random-aggregate-start");
+	AtomSpace* as = asp.get();
+
+	std::shared_ptr<Session> sess(
+		new Session(as, get_lexis(asp, poles, lexis, weight, params)));
+	RandomCallback* cb = new RandomCallback(as, sess->lex->dict, sess->basic);
+	sess->cb.reset(cb);
+	cb->set_weight_key(weight);
+	cb->set_sampler(sess->lex->sampler);
+	decode_params(params, *cb, sess->basic);
+	if (cb->auto_bounds)
+		GrowthAnalysis::apply(analyze_growth(as, sess->lex->dict, weight,
+		                                     params, root), *cb);
+	sess->params = params;
+
+	return add_session(std::move(sess), root);
+}
+
+/// Same as `do_simple_aggregate()`, but don't run it; instead, return
+/// a session, from which solutions can be pulled one at a time.
+Handle GenerateSCM::do_simple_start(Handle poles,
+                                    Handle lexis,
+                                    Handle params,
+                                    Handle root)
+{
+	AtomSpacePtr asp = SchemeSmob::ss_get_env_as("cog-simple-aggregate-start");
+	AtomSpace* as = asp.get();
+
+	std::shared_ptr<Session> sess(
+		new Session(as, get_lexis(asp, poles, lexis, Handle::UNDEFINED,
+		                          params)));
+	sess->cb.reset(new SimpleCallback(as, sess->lex->dict));
+	decode_params(params, *sess->cb, sess->basic);
+	sess->params = params;
+
+	return add_session(std::move(sess), root);
+}
+
+/// Return the next solution of the session, or the empty list, if
+/// there are no more. The session is closed after the last one.
+Handle GenerateSCM::do_next_solution(Handle key)
+{
+	std::shared_ptr<Session> sess;
+	{
+		std::lock_guard<std::mutex> lck(_sess_mtx);
+		auto it = _sessions.find(key);
+		if (_sessions.end() == it)
+			throw InvalidParamException(TRACE_INFO,
+				"Not an open aggregation session: %s",
+				key->to_short_string().c_str());
+		sess = it->second;
+	}
+
+	std::lock_guard<std::mutex> slck(sess->mtx);
+	if (sess->done) return Handle::UNDEFINED;
+
+	Handle soln = sess->ag.next_solution();
+	record_stats(sess->as, sess->params, sess->ag.stats());
+	if (soln) return sess->as->add_atom(soln);
+
+	// All done. Let the callback finish up, e.g. record the points.
+	sess->cb->get_solutions();
+	sess->done = true;
+	do_close(key);
+	return Handle::UNDEFINED;
+}
+
+/// Discard the session, without pulling any more solutions from it.
+/// A call to `do_next_solution()` that is running on it now is
+/// stopped; the session is freed when that call returns.
+void GenerateSCM::do_close(Handle key)
+{
+	std::lock_guard<std::mutex> lck(_sess_mtx);
+	auto it = _sessions.find(key);
+	if (_sessions.end() == it) return;
+	it->second->cancel = true;
+	_sessions.erase(it);
+}
+
+// ----------------------------------------------------------------
+GenerateSCM::Running::Running(GenerateSCM* scm, const Handle& params,
+                              GenerateCallback& cb)
+	: _scm(scm), _cancel(false)
+{
+	cb.cancel = &_cancel;
+	std::lock_guard<std::mutex> lck(_scm->_sess_mtx);
+	_it = _scm->_running.emplace(params, &_cancel);
+}
+
+GenerateSCM::Running::~Running()
+{
+	std::lock_guard<std::mutex> lck(_scm->_sess_mtx);
+	_scm->_running.erase(_it);
+}
+
+/// Stop the session, or all of the aggregations running with the
+/// given parameter anchor. They return the solutions found so far.
+void GenerateSCM::do_cancel(Handle key)
+{
+	std::lock_guard<std::mutex> lck(_sess_mtx);
+	auto it = _sessions.find(key);
+	if (_sessions.end() != it)
+		it->second->cancel = true;
+
+	auto rng = _running.equal_range(key);
+	for (auto rit = rng.first; rit != rng.second; rit++)
+		*rit->second = true;
+}
+
 // ----------------------------------------------------------------
 } /*end of namespace opencog*/
 
-GenerateSCM::GenerateSCM() : ModuleWrap("opencog generate") {}
+GenerateSCM::GenerateSCM() :
+	ModuleWrap("opencog generate"), _sess_count(0) {}
 
 /// This is called while (opencog generate) is the current module.
 /// Thus, all the definitions below happen in that module.
@@ -223,6 +1056,24 @@ void GenerateSCM::init(void)
 		&GenerateSCM::do_random_aggregate, this, "generate");
 	define_scheme_primitive("cog-simple-aggregate",
 		&GenerateSCM::do_simple_aggregate, this, "generate");
+	define_scheme_primitive("cog-compile-lexis",
+		&GenerateSCM::do_compile_lexis, this, "generate");
+	define_scheme_primitive("cog-clear-lexis-cache",
+		&GenerateSCM::do_clear_lexis_cache, this, "generate");
+	define_scheme_primitive("cog-set-section-weight!",
+		&GenerateSCM::do_set_weight, this, "generate");
+	define_scheme_primitive("cog-analyze-growth",
+		&GenerateSCM::do_analyze_growth, this, "generate");
+	define_scheme_primitive("cog-random-aggregate-start",
+		&GenerateSCM::do_random_start, this, "generate");
+	define_scheme_primitive("cog-simple-aggregate-start",
+		&GenerateSCM::do_simple_start, this, "generate");
+	define_scheme_primitive("cog-aggregate-next",
+		&GenerateSCM::do_next_solution, this, "generate");
+	define_scheme_primitive("cog-aggregate-close",
+		&GenerateSCM::do_close, this, "generate");
+	define_scheme_primitive("cog-aggregate-cancel",
+		&GenerateSCM::do_cancel, this, "generate");
 }
 
 extern "C" {
@@ -4,6 +4,7 @@
 
 (define-module (opencog generate))
 
+(use-modules (srfi srfi-41))
 (use-modules (opencog))
 (use-modules (opencog generate-config))
 (load-extension
@@ -13,6 +14,15 @@
 (export
 	cog-random-aggregate
 	cog-simple-aggregate
+	cog-random-aggregate-start
+	cog-simple-aggregate-start
+	cog-aggregate-next
+	cog-aggregate-close
+	cog-aggregate-cancel
+	cog-compile-lexis
+	cog-clear-lexis-cache
+	cog-set-section-weight!
+	cog-analyze-growth
 )
 
 (include-from-path "opencog/generate/gml-export.scm")
@@ -28,6 +38,35 @@
     connectable enpoints are given by POLES. Some parameters
     controlling the search are in PARAMS.
 
+    If the `*-num-threads-*` parameter is greater than one, then the
+    networks are generated on that many threads, in parallel.
+
+    If the `*-compact-engine-*` parameter is non-zero, then the
+    networks are generated by an engine that works with integers,
+    instead of atoms. It is faster, but single-threaded.
+
+    If the `*-lexis-file-*` parameter names a file, then the compact
+    engine uses the lexis compiled into it (see `cog-compile-lexis`),
+    instead of the POLES and the LEXIS. If there is no such file, it
+    is written.
+
+    If the `*-dedup-isomorphic-*` parameter is non-zero, then networks
+    that differ only in the naming of their points are reported once.
+
+    If the `*-prune-lexis-*` parameter is non-zero, then sections that
+    can never be used are removed from the LEXIS before starting.
+
+    If the `*-population-size-*` parameter is non-zero, then that many
+    partial networks are grown side by side, one layer at a time,
+    instead of one network at a time. It is single-threaded.
+
+    The dictionary pulled out of POLES and LEXIS is kept, and used
+    again by the next call with the same POLES, LEXIS and WEIGHT. If
+    MemberLinks were added to, or removed from the LEXIS since, only
+    those sections are updated. If weights were changed with
+    `cog-set-value!`, the weighted choices are all redone. See
+    `cog-set-section-weight!` and `cog-clear-lexis-cache`.
+
     See the example `basic-network.scm` for more details.
 ")
 
@@ -39,5 +78,299 @@
     in the LEXIS, and the connectable enpoints given by POLES. Some
     parameters controlling the search are in PARAMS.
 
+    If the `*-num-threads-*` parameter is greater than one, then the
+    search is split up among that many threads. The same networks are
+    found, as with a single thread, unless the search limits are hit.
+
+    If the `*-compact-engine-*` parameter is non-zero, then the
+    search is done by an engine that works with integers, instead of
+    atoms. It is faster, but single-threaded.
+
+    If the `*-dedup-isomorphic-*` parameter is non-zero, then networks
+    that differ only in the naming of their points are reported once.
+
+    If the `*-break-symmetry-*` parameter is non-zero, then odometer
+    states that differ only by a swap of identical connectors are
+    explored once. This can make the search much faster, when the
+    dictionary has sections with many copies of the same connector.
+
+    If the `*-memo-size-*` parameter is non-zero, then up to that many
+    dead ends are remembered, and are not explored again, when they
+    are reached by a different route. This is ignored by the compact
+    engine.
+
+    If the `*-prune-lexis-*` parameter is non-zero, then the sections
+    in the LEXIS that cannot be used (because some connector on them
+    cannot be attached to anything, or because they cannot be reached
+    from ROOT) are removed before the search starts.
+
+    If the `*-admissible-bounds-*` parameter is non-zero, then partial
+    networks that cannot be finished within the size and depth limits
+    are not explored.
+
+    If the `*-auto-bounds-*` parameter is non-zero, then the LEXIS is
+    first analyzed with `cog-analyze-growth`, and the size and depth
+    limits are lowered to the suggested ones.
+
+    If the `*-most-constrained-first-*` parameter is non-zero, then the
+    connectors that can be closed in the fewest ways are tried first.
+
     See the examples `dict-tree.scm` and `dict-loop.scm` for more details.
 ")
+
+(set-procedure-property! cog-compile-lexis 'documentation
+"
+  cog-compile-lexis POLES LEXIS WEIGHT FILE
+
+    Compile the sections in the LEXIS, with the POLES and the weights
+    found at WEIGHT, into a file, whose name is the name of the node
+    FILE. The `*-lexis-file-*` parameter of `cog-random-aggregate` and
+    `cog-simple-aggregate` maps the file into memory, which is much
+    faster than reading the LEXIS out of the AtomSpace. Many processes
+    can share one file. Returns FILE.
+
+    The file remembers the members of the POLES and the LEXIS that it
+    was compiled from. When they have changed since, the file is not
+    used; the aggregation functions compile it again. Changes to the
+    weights are not noticed; compile it again, after those.
+
+    Example:
+       (cog-compile-lexis pole-set lexis weights (Concept \"/tmp/my.lexis\"))
+")
+
+(set-procedure-property! cog-clear-lexis-cache 'documentation
+"
+  cog-clear-lexis-cache
+
+    Forget the dictionaries kept by `cog-random-aggregate` and the
+    other aggregation functions, freeing the memory they use. Changes
+    to the lexis, and to the weights on the sections, are noticed
+    without this.
+")
+
+(set-procedure-property! cog-set-section-weight! 'documentation
+"
+  cog-set-section-weight! SECTION WEIGHT VALUE
+
+    Set the weight of SECTION, at the key WEIGHT, to the NumberNode
+    VALUE. Both this and `cog-set-value!` are noticed by the next call
+    to `cog-random-aggregate`; but after this, only the weighted
+    choices holding SECTION are redone, instead of all of them.
+
+    Example:
+       (cog-set-section-weight! (make-person-type 2 3) node-weight (Number 0.1))
+")
+
+(set-procedure-property! cog-analyze-growth 'documentation
+"
+  cog-analyze-growth POLES LEXIS WEIGHT PARAMS ROOT
+
+    Predict how large the networks that `cog-random-aggregate` grows
+    from ROOT will be, without growing any. Each open connector is
+    closed by a section drawn by WEIGHT, and that section brings new
+    open connectors of its own; the LEXIS is treated as a branching
+    process. If, on average, an open connector leads to more than one
+    new one (the spectral radius is greater than one), then most
+    networks never stop growing; the fraction that do is the extinction
+    probability. Loops closed back onto the network are not accounted
+    for, so the prediction is on the large side.
+
+    The results are logged, and attached to PARAMS; see
+    `cog-growth-analysis`. Returns PARAMS.
+
+    Example:
+       (cog-analyze-growth pole-set lexis weights params (Concept \"peep 3\"))
+       (assoc-ref (cog-growth-analysis params) 'extinction)
+")
+
+(set-procedure-property! cog-random-aggregate-start 'documentation
+"
+  cog-random-aggregate-start POLES LEXIS WEIGHT PARAMS ROOT
+
+    Same as `cog-random-aggregate`, except that nothing is generated
+    yet. Instead, a session is returned; use `cog-aggregate-next` to
+    get the networks, one at a time. The session always runs on a
+    single thread, with the atom-based engine; the `*-num-threads-*`
+    and `*-compact-engine-*` parameters are ignored.
+
+    See also `cog-random-aggregate-stream`.
+")
+
+(set-procedure-property! cog-simple-aggregate-start 'documentation
+"
+  cog-simple-aggregate-start POLES LEXIS PARAMS ROOT
+
+    Same as `cog-simple-aggregate`, except that nothing is generated
+    yet. Instead, a session is returned; use `cog-aggregate-next` to
+    get the networks, one at a time. The session always runs on a
+    single thread, with the atom-based engine; the `*-num-threads-*`
+    and `*-compact-engine-*` parameters are ignored.
+
+    See also `cog-simple-aggregate-stream`.
+")
+
+(set-procedure-property! cog-aggregate-next 'documentation
+"
+  cog-aggregate-next SESSION
+
+    Return the next network found in SESSION, as a SetLink of
+    Sections. The search is run only until this network is found.
+    When there are no more, the empty list is returned, and the
+    session is closed.
+")
+
+(set-procedure-property! cog-aggregate-close 'documentation
+"
+  cog-aggregate-close SESSION
+
+    Discard SESSION, without generating any more networks from it.
+    Sessions are closed automatically after their last network.
+")
+
+(set-procedure-property! cog-aggregate-cancel 'documentation
+"
+  cog-aggregate-cancel KEY
+
+    Stop a running aggregation; it returns the networks found so far.
+    If KEY is a session, then the session is stopped: the network
+    being searched for by `cog-aggregate-next`, if any, is abandoned,
+    and no more are generated. Otherwise, KEY is taken to be a PARAMS
+    anchor, and all of the `cog-random-aggregate` and
+    `cog-simple-aggregate` calls now running with those PARAMS are
+    stopped. Meant to be called from another thread. Aggregations
+    started later are not affected.
+
+    See also the `*-max-time-*` parameter, which stops the search
+    after that many seconds.
+")
+
+; ----------------------------------------------------------
+; Lazy streams of networks
+
+(define-stream (session-stream SESSION)
+	(let ((soln (cog-aggregate-next SESSION)))
+		(if (null? soln)
+			stream-null
+			(stream-cons soln (session-stream SESSION)))))
+
+; A stream that is dropped before its end never gets to close its
+; session; the guardian hands back the session once the stream is
+; gone, and it is closed after the next garbage collection. Closing
+; a session twice is harmless.
+(define session-guardian (make-guardian))
+
+(define (close-dropped-sessions)
+	(let ((sess (session-guardian)))
+		(when sess
+			(cog-aggregate-close sess)
+			(close-dropped-sessions))))
+
+(add-hook! after-gc-hook close-dropped-sessions)
+
+(define (guarded-stream SESSION)
+	(session-guardian SESSION)
+	(session-stream SESSION))
+
+(define-public (cog-random-aggregate-stream POLES LEXIS WEIGHT PARAMS ROOT)
+"
+  cog-random-aggregate-stream POLES LEXIS WEIGHT PARAMS ROOT
+
+    Same as `cog-random-aggregate`, except that a lazy SRFI-41 stream
+    of networks is returned. Each network is generated only when it
+    is asked for. For example,
+        (stream-car (cog-random-aggregate-stream ...))
+    stops after the first network.
+
+    The session behind the stream is closed when the last network has
+    been taken. A stream that is dropped before then is closed after
+    it is garbage-collected; until then, it holds on to its partial
+    networks. To let go of them at once, use the session directly:
+        (define sess (cog-random-aggregate-start ...))
+        (define first-net (cog-aggregate-next sess))
+        (cog-aggregate-close sess)
+"
+	(guarded-stream
+		(cog-random-aggregate-start POLES LEXIS WEIGHT PARAMS ROOT))
+)
+
+(define-public (cog-simple-aggregate-stream POLES LEXIS PARAMS ROOT)
+"
+  cog-simple-aggregate-stream POLES LEXIS PARAMS ROOT
+
+    Same as `cog-simple-aggregate`, except that a lazy SRFI-41 stream
+    of networks is returned. Each network is generated only when it
+    is asked for. For example,
+        (stream->list 3 (cog-simple-aggregate-stream ...))
+    stops after the first three networks. As with
+    `cog-random-aggregate-stream`, a stream that is dropped before its
+    end is closed only after it is garbage-collected.
+"
+	(guarded-stream
+		(cog-simple-aggregate-start POLES LEXIS PARAMS ROOT))
+)
+
+; ----------------------------------------------------------
+; Search statistics
+
+(define-public (cog-aggregate-stats PARAMS)
+"
+  cog-aggregate-stats PARAMS
+
+    Return the statistics of the last search that ran with PARAMS, as
+    an association list. The counts include the number of odometers
+    pushed and popped, of frames pushed, of selects (and of selects
+    that found nothing), of odometers that rolled over, of solutions,
+    and of solutions seen before, as well as the deepest odometer
+    depth, the number of atoms left in the scratch space, and the
+    seconds taken to the first solution (negative, if none) and in all.
+    The entries 'depth-odometers and 'depth-wheels are lists, indexed
+    by odometer depth, giving the number of odometers set up at that
+    depth, and the total number of wheels on them. The entry
+    'lexis-cache tells how the dictionary was had: \"reused\" from the
+    last call, \"updated\" in place, or \"built\" afresh. Returns the
+    empty list, if nothing ran with PARAMS. Sessions update these
+    after each `cog-aggregate-next`.
+
+    Example:
+        (cog-random-aggregate ... PARAMS ...)
+        (assoc-ref (cog-aggregate-stats PARAMS) 'solutions)
+"
+	(define stats (cog-value PARAMS (Predicate "*-aggregate-stats-*")))
+	(define cache (cog-value PARAMS (Predicate "*-lexis-cache-*")))
+	(define (decode PAIR)
+		(define vals (cog-value->list (cog-value-ref PAIR 1)))
+		(cons (string->symbol (cog-value-ref PAIR 0))
+			(if (= 1 (length vals)) (car vals) vals)))
+	(if (not (cog-value? stats)) '()
+		(append (map decode (cog-value->list stats))
+			(if (cog-value? cache)
+				(list (cons 'lexis-cache (cog-value-ref cache 0)))
+				'())))
+)
+
+(define-public (cog-growth-analysis PARAMS)
+"
+  cog-growth-analysis PARAMS
+
+    Return the results of the last `cog-analyze-growth` with PARAMS,
+    or of the last `cog-random-aggregate` with the `*-auto-bounds-*`
+    parameter set, as an association list. The entries are the
+    'spectral-radius of the mean offspring matrix, the 'extinction
+    probability, the 'mean-size and 'size-deviation of the networks
+    (in sections; infinite, if the spectral radius is one or more),
+    the 'mean-depth, and the 'suggested-size and 'suggested-depth
+    bounds. Returns the empty list, if no analysis was made.
+
+    The analysis follows the random aggregation: a connector that
+    has several joints is always closed through the first of them,
+    and so the sections of the other joints are not counted. Loops
+    closed back onto the network are not counted either, and so the
+    sizes are on the large side.
+"
+	(define stats (cog-value PARAMS (Predicate "*-growth-analysis-*")))
+	(define (decode PAIR)
+		(cons (string->symbol (cog-value-ref PAIR 0))
+			(cog-value-ref (cog-value-ref PAIR 1) 0)))
+	(if (not (cog-value? stats)) '()
+		(map decode (cog-value->list stats)))
+)